@@ -0,0 +1,508 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "archive.h"
+
+/// Фазы сжатия и распаковки, измеряемые по отдельности.
+enum {
+    PHASE_HISTOGRAM,        ///< create_freq_table()
+    PHASE_LENGTHS,          ///< build_code_lengths()
+    PHASE_CODES,            ///< generate_canonical_codes()
+    PHASE_ENCODE,           ///< encode_payload()
+    PHASE_DECODE,           ///< decode_block()
+    PHASE_COUNT
+};
+
+/// Названия фаз для отчёта.
+static const char *PHASE_NAMES[PHASE_COUNT] = { "histogram", "code lengths", "code gen", "encode", "decode" };
+
+/// Прогоны корпуса через compress_archive() и decompress_archive() с параметрами по умолчанию.
+enum {
+    ARCHIVE_COMPRESS_SINGLE,    ///< Сжатие в один поток.
+    ARCHIVE_DECOMPRESS_SINGLE,  ///< Распаковка в один поток.
+    ARCHIVE_COMPRESS_THREADS,   ///< Сжатие в -j потоков.
+    ARCHIVE_DECOMPRESS_THREADS, ///< Распаковка в -j потоков.
+    ARCHIVE_COUNT
+};
+
+/// Названия прогонов архива для отчёта.
+static const char *ARCHIVE_NAMES[ARCHIVE_COUNT] = { "archive c 1", "archive d 1", "archive c N", "archive d N" };
+
+/// Размер одного «крошечного файла».
+enum { TINY_SIZE = 64 };
+
+/**
+ * Генератор данных корпуса: заполняет буфер очередной порцией.
+ */
+typedef void (*Generator)(unsigned char *data, size_t size, unsigned long long *state);
+
+/**
+ * Тестовый корпус.
+ */
+typedef struct Corpus {
+    const char *name;               ///< Название.
+    Generator generate;             ///< Генератор данных.
+    unsigned long long size;        ///< Общий размер данных.
+    size_t chunk;                   ///< Размер блока (0 — размер блока из параметров).
+    int archive;                    ///< 1 - прогнать корпус и через архив (run_archive()).
+} Corpus;
+
+/**
+ * Результаты измерений одного корпуса.
+ */
+typedef struct Result {
+    double seconds[PHASE_COUNT];    ///< Суммарное время каждой фазы.
+    double archive_seconds[ARCHIVE_COUNT]; ///< Время прогонов через архив.
+    long rss;                       ///< Пиковый RSS поблочного прогона (run_corpus()), КБ.
+    long archive_rss;               ///< Пиковый RSS прогона через архив (run_archive()), КБ.
+    unsigned long long in;          ///< Размер исходных данных.
+    unsigned long long out;         ///< Размер сжатых данных (с заголовками блоков).
+} Result;
+
+static unsigned long long next_random(unsigned long long *state) {
+    /**
+     * @brief Возвращает следующее псевдослучайное число (xorshift64).
+     *
+     * @param state Состояние генератора.
+     * @return Псевдослучайное число.
+     */
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void generate_uniform(unsigned char *data, size_t size, unsigned long long *state) {
+    /**
+     * @brief Равномерно распределённые случайные байты.
+     */
+    for (size_t i = 0; i < size; i++)
+        data[i] = (unsigned char)next_random(state);
+}
+
+static void generate_text(unsigned char *data, size_t size, unsigned long long *state) {
+    /**
+     * @brief Текстоподобные данные: слова из букв с частотами английского языка.
+     */
+    static const char letters[] = "eeeeeeeeeeeetttttttttaaaaaaaaooooooooiiiiiiinnnnnnnsssssshhhhhhrrrrrrdddd"
+                                  "llllcccuuummwwffggyyppbvk";
+    for (size_t i = 0; i < size; i++) {
+        unsigned long long r = next_random(state);
+        if (r % 6 == 0)
+            data[i] = (r % 60 == 0) ? '\n' : ' ';
+        else
+            data[i] = (unsigned char)letters[(r >> 8) % (sizeof(letters) - 1)];
+    }
+}
+
+static void generate_skewed(unsigned char *data, size_t size, unsigned long long *state) {
+    /**
+     * @brief Сильно перекошенное (геометрическое) распределение байтов.
+     */
+    for (size_t i = 0; i < size; i++) {
+        unsigned long long r = next_random(state);
+        unsigned char symbol = 0;
+        while ((r & 1) && symbol < 255) {
+            r >>= 1;
+            symbol++;
+            if (r == 0)
+                r = next_random(state);
+        }
+        data[i] = symbol;
+    }
+}
+
+static void generate_single(unsigned char *data, size_t size, unsigned long long *state) {
+    /**
+     * @brief Один и тот же байт.
+     */
+    (void)state;
+    memset(data, 'a', size);
+}
+
+static double now(void) {
+    /**
+     * @brief Возвращает монотонное время в секундах.
+     */
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void finish_phase(Result *result, size_t phase, double start) {
+    /**
+     * @brief Добавляет время фазы.
+     *
+     * @param result Результаты корпуса.
+     * @param phase Номер фазы.
+     * @param start Время начала фазы.
+     */
+    result->seconds[phase] += now() - start;
+}
+
+static int run_corpus(const Corpus *corpus, size_t block_size, size_t max_length, Result *result) {
+    /**
+     * @brief Сжимает и распаковывает корпус поблочно, измеряя каждую фазу.
+     *
+     * Данные генерируются по блоку, поэтому многогигабайтные корпуса
+     * не требуют памяти сверх размера блока. Каждый блок после распаковки
+     * сравнивается с исходным.
+     *
+     * @param corpus Корпус.
+     * @param block_size Размер блока.
+     * @param max_length Максимальная длина кода.
+     * @param result Результаты измерений.
+     * @return 1 - при успехе; 0 - при ошибке памяти или несовпадении данных.
+     */
+    size_t chunk = corpus->chunk ? corpus->chunk : block_size;
+    unsigned char *data = (unsigned char*)malloc(chunk);
+    unsigned char *out = (unsigned char*)malloc(chunk);
+    Writer payload;
+    int writer_ready = init_memory_writer(&payload, chunk + BITIO_BUFFER_SIZE);
+    DecodeTable *table = (DecodeTable*)malloc(sizeof(DecodeTable));
+    unsigned long long state = 88172645463325252ULL;
+    int ok = data && out && writer_ready && table;
+    if (table)
+        init_decode_table(table);
+
+    for (unsigned long long done = 0; ok && done < corpus->size; ) {
+        size_t size = (corpus->size - done < chunk) ? (size_t)(corpus->size - done) : chunk;
+        corpus->generate(data, size, &state);
+
+        double start = now();
+        unsigned long long freq_table[ALPHABET_SIZE] = { 0 };
+        create_freq_table(data, size, freq_table);
+        finish_phase(result, PHASE_HISTOGRAM, start);
+
+        start = now();
+        unsigned char lengths[ALPHABET_SIZE];
+        build_code_lengths(freq_table, max_length, lengths);
+        finish_phase(result, PHASE_LENGTHS, start);
+
+        start = now();
+        Code code_table[ALPHABET_SIZE];
+        generate_canonical_codes(lengths, code_table);
+        finish_phase(result, PHASE_CODES, start);
+
+        start = now();
+        BlockHeader header;
+        header.type = encode_payload(data, size, freq_table, lengths, code_table, &payload);
+        header.original_size = size;
+        header.payload_size = payload.pos;
+        finish_phase(result, PHASE_ENCODE, start);
+
+        start = now();
+        ok = !payload.error && decode_block(&header, payload.buffer, table, out);
+        finish_phase(result, PHASE_DECODE, start);
+
+        ok = ok && memcmp(data, out, size) == 0;
+        result->in += size;
+        result->out += 1 + varint_size(size) + varint_size(payload.pos) + payload.pos;
+        done += size;
+    }
+
+    free(data);
+    free(out);
+    free(table);
+    if (writer_ready)
+        delete_writer(&payload);
+    return ok;
+}
+
+static int same_files(FILE *first, FILE *second, unsigned char *a, unsigned char *b, size_t chunk) {
+    /**
+     * @brief Сравнивает содержимое двух файлов с начала до конца.
+     *
+     * @param first Первый файл.
+     * @param second Второй файл.
+     * @param a Буфер на chunk байтов.
+     * @param b Второй буфер на chunk байтов.
+     * @param chunk Размер буферов.
+     * @return 1 - если файлы совпадают; 0 - иначе.
+     */
+    rewind(first);
+    rewind(second);
+    for (;;) {
+        size_t size = fread(a, sizeof(char), chunk, first);
+        if (fread(b, sizeof(char), chunk, second) != size || memcmp(a, b, size) != 0)
+            return 0;
+        if (size < chunk)
+            return 1;
+    }
+}
+
+static int check_extract(FILE *input, FILE *archive, unsigned long long size, size_t block_size,
+                         unsigned char *a, unsigned char *b) {
+    /**
+     * @brief Извлекает из архива с индексом диапазон на стыке блоков и сверяет его с исходным.
+     *
+     * @param input Исходный файл.
+     * @param archive Архив.
+     * @param size Размер исходного файла.
+     * @param block_size Размер блока (и буферов a и b).
+     * @param a Буфер на block_size байтов.
+     * @param b Второй буфер на block_size байтов.
+     * @return 1 - если диапазон совпал; 0 - иначе.
+     */
+    unsigned long long offset = (size > block_size) ? size / 2 - block_size / 2 : 0;
+    size_t length = (size - offset < block_size) ? (size_t)(size - offset) : block_size;
+    FILE *range = tmpfile();
+    Options options;
+    init_options(&options);
+    rewind(archive);
+    int ok = range && extract_archive(archive, range, offset, length, &options) && fflush(range) == 0
+        && fseeko(input, (off_t)offset, SEEK_SET) == 0 && fread(a, sizeof(char), length, input) == length;
+    if (ok) {
+        rewind(range);
+        ok = fread(b, sizeof(char), block_size, range) == length && memcmp(a, b, length) == 0;
+    }
+    if (range)
+        fclose(range);
+    return ok;
+}
+
+static int run_archive(const Corpus *corpus, size_t block_size, size_t max_length, size_t threads, Result *result) {
+    /**
+     * @brief Прогоняет корпус через compress_archive() и decompress_archive().
+     *
+     * Корпус записывается во временный файл и сжимается в один и в threads
+     * потоков со всеми сочетаниями --index и --no-reuse; каждый архив
+     * распаковывается тем же числом потоков и сравнивается с исходным,
+     * а архив с индексом дополнительно проверяется извлечением диапазона.
+     * Время замеряется для параметров по умолчанию (без индекса, с
+     * переиспользованием таблиц). Так проверяются выбор типа блока,
+     * переиспользование таблиц, потоки и индекс.
+     *
+     * @param corpus Корпус.
+     * @param block_size Размер блока.
+     * @param max_length Максимальная длина кода.
+     * @param threads Количество потоков для многопоточного прогона.
+     * @param result Результаты измерений.
+     * @return 1 - при успехе; 0 - при ошибке или несовпадении данных.
+     */
+    unsigned char *a = (unsigned char*)malloc(block_size);
+    unsigned char *b = (unsigned char*)malloc(block_size);
+    FILE *input = tmpfile();
+    unsigned long long state = 88172645463325252ULL;
+    int ok = a && b && input;
+    for (unsigned long long done = 0; ok && done < corpus->size; ) {
+        size_t size = (corpus->size - done < block_size) ? (size_t)(corpus->size - done) : block_size;
+        corpus->generate(a, size, &state);
+        ok = fwrite(a, sizeof(char), size, input) == size;
+        done += size;
+    }
+    ok = ok && fflush(input) == 0;
+
+    for (size_t variant = 0; ok && variant < 8; variant++) {
+        Options options;
+        init_options(&options);
+        options.block_size = block_size;
+        options.max_code_length = max_length;
+        options.threads = (variant & 1) ? threads : 1;
+        options.index = (variant & 2) != 0;
+        options.reuse_tables = (variant & 4) == 0;
+        size_t run = (variant & 1) ? ARCHIVE_COMPRESS_THREADS : ARCHIVE_COMPRESS_SINGLE;
+        FILE *archive = tmpfile(), *output = tmpfile();
+
+        rewind(input);
+        double start = now();
+        ok = archive && output && compress_archive(input, archive, &options) && fflush(archive) == 0;
+        if (variant < 2)
+            result->archive_seconds[run] += now() - start;
+
+        rewind(archive);
+        start = now();
+        ok = ok && decompress_archive(archive, output, &options) && fflush(output) == 0;
+        if (variant < 2)
+            result->archive_seconds[run + 1] += now() - start;
+
+        ok = ok && same_files(input, output, a, b, block_size)
+            && (!options.index || check_extract(input, archive, corpus->size, block_size, a, b));
+        if (archive)
+            fclose(archive);
+        if (output)
+            fclose(output);
+    }
+
+    free(a);
+    free(b);
+    if (input)
+        fclose(input);
+    return ok;
+}
+
+static int run_isolated(const Corpus *corpus, size_t block_size, size_t max_length, size_t threads,
+                        int archive, Result *result) {
+    /**
+     * @brief Выполняет run_corpus() или run_archive() в дочернем процессе.
+     *
+     * Результаты возвращаются через канал, а пиковый RSS берётся из wait4()
+     * для этого процесса, поэтому он не включает память предыдущих прогонов.
+     *
+     * @param corpus Корпус.
+     * @param block_size Размер блока.
+     * @param max_length Максимальная длина кода.
+     * @param threads Количество потоков для многопоточного прогона через архив.
+     * @param archive 1 - run_archive(); 0 - run_corpus().
+     * @param result Результаты измерений (дополняются результатами прогона).
+     * @return 1 - при успехе; 0 - при ошибке прогона или создания процесса.
+     */
+    int fds[2];
+    if (pipe(fds) != 0)
+        return 0;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        int ok = archive ? run_archive(corpus, block_size, max_length, threads, result)
+                         : run_corpus(corpus, block_size, max_length, result);
+        ok = ok && write(fds[1], result, sizeof(*result)) == (ssize_t)sizeof(*result);
+        _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    close(fds[1]);
+    Result received;
+    int ok = pid > 0 && read(fds[0], &received, sizeof(received)) == (ssize_t)sizeof(received);
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    ok = pid > 0 && wait4(pid, &status, 0, &usage) == pid && ok
+        && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+    if (ok) {
+        *result = received;
+        if (archive)
+            result->archive_rss = usage.ru_maxrss;
+        else
+            result->rss = usage.ru_maxrss;
+    }
+    return ok;
+}
+
+static int parse_size(const char *text, unsigned long long *value) {
+    /**
+     * @brief Разбирает размер с необязательным суффиксом K, M или G.
+     *
+     * @param text Строка с числом.
+     * @param value Указатель для результата.
+     * @return 1 - при успехе; 0 - если строка некорректна или число переполняется.
+     */
+    if (*text < '0' || *text > '9')
+        return 0;
+    char *end;
+    errno = 0;
+    unsigned long long number = strtoull(text, &end, 10);
+    if (errno == ERANGE)
+        return 0;
+    int shift = 0;
+    if (*end == 'K' || *end == 'k')
+        shift = 10;
+    else if (*end == 'M' || *end == 'm')
+        shift = 20;
+    else if (*end == 'G' || *end == 'g')
+        shift = 30;
+    if (shift) {
+        if (number > (ULLONG_MAX >> shift))
+            return 0;
+        number <<= shift;
+        end++;
+    }
+    *value = number;
+    return *end == '\0';
+}
+
+static void print_usage(void) {
+    /**
+     * @brief Выводит справку по параметрам бенчмарка.
+     */
+    fputs("Usage: huffman_bench [-n size] [-g size] [-b block] [-l length] [-j threads]\n"
+          "  -n size    size of each corpus (default 64M)\n"
+          "  -g size    size of the large corpus, e.g. 4G (default 0, skipped)\n"
+          "  -b block   block size (default 1M)\n"
+          "  -l length  maximum code length (default 15)\n"
+          "  -j threads threads for the multi-threaded archive run, 1..256 (default 4)\n", stderr);
+}
+
+int main(int argc, char **argv) {
+    /**
+     * @brief Прогоняет все корпуса и печатает скорость каждой фазы.
+     *
+     * Для каждой фазы выводятся МБ/с и нс/байт, для корпуса — степень сжатия.
+     * Корпуса с полными блоками затем проходят через архив (run_archive())
+     * в один и в -j потоков. Каждый прогон выполняется в своём процессе
+     * (run_isolated()), и для него выводится пиковый RSS. Код возврата
+     * ненулевой, если какой-либо блок или архив распаковался не в исходные данные.
+     */
+    unsigned long long size = 64ULL << 20, large = 0, block = DEFAULT_BLOCK_SIZE, length = DEFAULT_CODE_LENGTH;
+    unsigned long long threads = 4;
+    for (int i = 1; i < argc; i++) {
+        unsigned long long *target = NULL;
+        if (strcmp(argv[i], "-n") == 0)
+            target = &size;
+        else if (strcmp(argv[i], "-g") == 0)
+            target = &large;
+        else if (strcmp(argv[i], "-b") == 0)
+            target = &block;
+        else if (strcmp(argv[i], "-l") == 0)
+            target = &length;
+        else if (strcmp(argv[i], "-j") == 0)
+            target = &threads;
+        if (!target || i + 1 == argc || !parse_size(argv[++i], target)) {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (block < MIN_BLOCK_SIZE || block > MAX_BLOCK_SIZE || length < 1 || length > MAX_CODE_LENGTH
+        || threads < 1 || threads > MAX_THREADS) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    Corpus corpora[] = {
+        { "uniform", generate_uniform, size, 0, 1 },
+        { "text", generate_text, size, 0, 1 },
+        { "skewed", generate_skewed, size, 0, 1 },
+        { "single", generate_single, size, 0, 1 },
+        { "tiny", generate_text, size / 64, TINY_SIZE, 0 },
+        { "large", generate_text, large, 0, 0 },
+    };
+
+    int ok = 1;
+    printf("%-8s %-13s %10s %10s\n", "corpus", "phase", "MB/s", "ns/byte");
+    for (size_t c = 0; c < sizeof(corpora) / sizeof(corpora[0]); c++) {
+        if (corpora[c].size == 0)
+            continue;
+        Result result;
+        memset(&result, 0, sizeof(result));
+        if (!run_isolated(&corpora[c], (size_t)block, (size_t)length, (size_t)threads, 0, &result)) {
+            fprintf(stderr, "%s: round trip failed\n", corpora[c].name);
+            ok = 0;
+            continue;
+        }
+        for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+            double seconds = result.seconds[phase];
+            printf("%-8s %-13s %10.1f %10.3f\n", corpora[c].name, PHASE_NAMES[phase],
+                   seconds > 0 ? result.in / seconds / 1e6 : 0.0, seconds * 1e9 / result.in);
+        }
+        printf("%-8s %-13s %10.3f\n", corpora[c].name, "ratio", (double)result.out / result.in);
+        printf("%-8s %-13s %10ld\n", corpora[c].name, "peak RSS KB", result.rss);
+        if (corpora[c].archive && !run_isolated(&corpora[c], (size_t)block, (size_t)length, (size_t)threads, 1,
+                                                &result)) {
+            fprintf(stderr, "%s: archive round trip failed\n", corpora[c].name);
+            ok = 0;
+        }
+        else if (corpora[c].archive) {
+            for (size_t run = 0; run < ARCHIVE_COUNT; run++) {
+                double seconds = result.archive_seconds[run];
+                printf("%-8s %-13s %10.1f %10.3f\n", corpora[c].name, ARCHIVE_NAMES[run],
+                       seconds > 0 ? result.in / seconds / 1e6 : 0.0, seconds * 1e9 / result.in);
+            }
+            printf("%-8s %-13s %10ld\n", corpora[c].name, "arch RSS KB", result.archive_rss);
+        }
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
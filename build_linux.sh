@@ -8,7 +8,7 @@ then
 fi
 
 # Компиляция проекта
-gcc -Wall -Wextra -O2 -Iinclude src/bitio.c src/bitset.c src/queue.c src/tree.c src/main.c -o huffman_archiver
+gcc -Wall -Wextra -O2 -pthread -Iinclude src/bitio.c src/codes.c src/histogram.c src/decoder.c src/block.c src/pool.c src/mapping.c src/stats.c src/archive.c src/main.c -lm -o huffman_archiver
 
 
 # Проверка успешности компиляции
@@ -17,4 +17,31 @@ if [ $? -eq 0 ]; then
 else
     echo "Ошибка при сборке."
     exit 1
-fi
\ No newline at end of file
+fi
+
+# Компиляция бенчмарка
+gcc -Wall -Wextra -O2 -pthread -Iinclude src/bitio.c src/codes.c src/histogram.c src/decoder.c src/block.c src/pool.c src/mapping.c src/stats.c src/archive.c bench/huffman_bench.c -lm -o huffman_bench
+
+if [ $? -eq 0 ]; then
+    echo "Бенчмарк собран: ./huffman_bench"
+else
+    echo "Ошибка при сборке бенчмарка."
+    exit 1
+fi
+
+# Сборка библиотеки libhuffman (статической и разделяемой)
+LIB_OBJECTS=""
+mkdir -p obj
+for source in src/bitio.c src/codes.c src/histogram.c src/decoder.c src/block.c src/huffman.c src/stream.c; do
+    object="obj/$(basename "$source" .c).o"
+    gcc -Wall -Wextra -O2 -fPIC -Iinclude -c "$source" -o "$object" || { echo "Ошибка при сборке библиотеки."; exit 1; }
+    LIB_OBJECTS="$LIB_OBJECTS $object"
+done
+ar rcs libhuffman.a $LIB_OBJECTS && gcc -shared $LIB_OBJECTS -lm -o libhuffman.so
+
+if [ $? -eq 0 ]; then
+    echo "Библиотека собрана: ./libhuffman.a, ./libhuffman.so (заголовок include/huffman.h)"
+else
+    echo "Ошибка при сборке библиотеки."
+    exit 1
+fi
@@ -10,7 +10,7 @@ if %errorlevel% neq 0 (
 )
 
 :: Компиляция проекта
-gcc -Wall -Wextra -O2 -Iinclude src/bitio.c src/bitset.c src/queue.c src/tree.c src/main.c -o huffman_archiver.exe
+gcc -Wall -Wextra -O2 -pthread -Iinclude src/bitio.c src/codes.c src/histogram.c src/decoder.c src/block.c src/pool.c src/mapping.c src/stats.c src/archive.c src/main.c -lm -o huffman_archiver.exe
 
 :: Проверка успешности компиляции
 if %errorlevel% equ 0 (
@@ -21,4 +21,25 @@ if %errorlevel% equ 0 (
     exit /b 1
 )
 
+:: Сборка библиотеки libhuffman (статической и DLL)
+if not exist obj mkdir obj
+for %%f in (bitio codes histogram decoder block huffman stream) do (
+    gcc -Wall -Wextra -O2 -Iinclude -c src\%%f.c -o obj\%%f.o
+    if errorlevel 1 (
+        echo Ошибка при сборке библиотеки.
+        pause
+        exit /b 1
+    )
+)
+ar rcs libhuffman.a obj\bitio.o obj\codes.o obj\histogram.o obj\decoder.o obj\block.o obj\huffman.o obj\stream.o
+gcc -shared obj\bitio.o obj\codes.o obj\histogram.o obj\decoder.o obj\block.o obj\huffman.o obj\stream.o -lm -o huffman.dll
+
+if %errorlevel% equ 0 (
+    echo Библиотека собрана: libhuffman.a, huffman.dll (заголовок include\huffman.h)
+) else (
+    echo Ошибка при сборке библиотеки.
+    pause
+    exit /b 1
+)
+
 pause
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include "block.h"
+#include "pool.h"
+#include "mapping.h"
+#include "stats.h"
+
+/**
+ * Параметры сжатия и распаковки.
+ */
+typedef struct Options {
+    size_t max_code_length;     ///< Максимальная длина кода Хаффмана.
+    size_t block_size;          ///< Размер блока исходных данных.
+    size_t threads;             ///< Количество рабочих потоков.
+    int index;                  ///< 1 - дописывать к архиву индекс блоков (ARCHIVE_INDEXED).
+    int reuse_tables;           ///< 1 - разрешить блокам использовать таблицу кодов предыдущего блока.
+    Stats *stats;               ///< Статистика работы (NULL — не собирать).
+} Options;
+
+/**
+ * Заполняет параметры сжатия значениями по умолчанию.
+ */
+void init_options(Options *options);
+
+/**
+ * Сжимает входной файл поблочно и записывает архив в выходной файл.
+ */
+int compress_archive(FILE *input, FILE *output, const Options *options);
+
+/**
+ * Распаковывает архив из входного файла в выходной файл.
+ */
+int decompress_archive(FILE *input, FILE *output, const Options *options);
+
+/**
+ * Распаковывает из архива только байты [offset, offset + length) исходного файла.
+ */
+int extract_archive(FILE *input, FILE *output, unsigned long long offset, unsigned long long length,
+                    const Options *options);
@@ -1,30 +1,71 @@
 #pragma once
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+/// Принудительная подстановка функций горячих циклов декодирования.
+#if defined(__GNUC__)
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE static inline
+#endif
+
+/// Размер собственного байтового буфера Writer и Reader.
+enum { BITIO_BUFFER_SIZE = 1 << 16 };
+
+/// Максимальное количество битов за одну операцию write_bits() или peek_bits().
+enum { BITIO_MAX_BITS = 57 };
 
 /**
- * Структура для записи битов в файл.
+ * Структура для записи битов в файл или в растущий буфер в памяти.
  */
 typedef struct {
-    FILE* output;             ///< Указатель на выходной файл.
-    unsigned char byte;       ///< Буфер для накопления битов.
-    size_t bits_filled;       ///< Количество заполненных битов в буфере.
+    FILE* output;               ///< Указатель на выходной файл (NULL — запись в память).
+    unsigned long long acc;     ///< Аккумулятор битов (значащие биты — младшие).
+    size_t bits_filled;         ///< Количество битов в аккумуляторе.
+    unsigned char *buffer;      ///< Буфер готовых байтов, сбрасываемый через fwrite.
+    size_t pos;                 ///< Количество байтов в буфере.
+    size_t capacity;            ///< Размер буфера.
+    int error;                  ///< Признак ошибки записи или выделения памяти.
 } Writer;
 
 /**
- * Структура для чтения битов из файла.
+ * Структура для чтения битов из файла или из области памяти.
  */
 typedef struct {
-    FILE* input;              ///< Указатель на входной файл.
-    unsigned char byte;       ///< Буфер для текущего байта при побитовой обработке.
-    unsigned char buf;        ///< Следующий байт из файла.
-    size_t bits_filled;       ///< Количество оставшихся битов для чтения в текущем байте.
+    FILE* input;                ///< Указатель на входной файл (NULL — чтение из памяти).
+    unsigned long long acc;     ///< Аккумулятор битов (значащие биты — младшие).
+    size_t bits_filled;         ///< Количество непрочитанных битов в аккумуляторе.
+    unsigned char *buffer;      ///< Буфер байтов, заполняемый через fread (или читаемая память).
+    size_t pos;                 ///< Позиция следующего байта в буфере.
+    size_t size;                ///< Количество байтов в буфере.
+    int eof;                    ///< Признак исчерпания входного файла.
 } Reader;
 
 /**
- * Инициализирует структуру Writer.
+ * Инициализирует структуру Writer и выделяет её буфер.
+ */
+int init_writer(Writer *writer, FILE* output);
+
+/**
+ * Инициализирует Writer для записи в растущий буфер в памяти.
  */
-void init_writer(Writer *writer, FILE* output);
+int init_memory_writer(Writer *writer, size_t capacity);
+
+/**
+ * Сбрасывает целые байты из аккумулятора в буфер (и буфер в файл при заполнении).
+ */
+void flush_bits(Writer *writer);
+
+/**
+ * Записывает n младших битов значения, начиная со старшего из них (n <= BITIO_MAX_BITS).
+ */
+static inline void write_bits(Writer *writer, unsigned long long value, size_t n) {
+    if (writer->bits_filled + n > 64)
+        flush_bits(writer);
+    writer->acc = (writer->acc << n) | (value & ((1ULL << n) - 1));
+    writer->bits_filled += n;
+}
 
 /**
  * Записывает один бит в выходной поток.
@@ -42,14 +83,108 @@ void write_byte(Writer *writer, unsigned char byte);
 void write_number(Writer *writer, unsigned number, size_t bits);
 
 /**
- * Записывает оставшиеся в буфере биты в файл, дополняя их нулями.
+ * Записывает последовательность байтов (поток должен быть выровнен по байту).
+ */
+void write_bytes(Writer *writer, const void *data, size_t size);
+
+/**
+ * Записывает беззнаковое число в формате varint (по 7 битов в байте, младшие первыми).
+ */
+void write_varint(Writer *writer, unsigned long long value);
+
+/**
+ * Возвращает количество байтов числа в формате varint.
+ */
+size_t varint_size(unsigned long long value);
+
+/**
+ * Дописывает оставшиеся биты, дополняя их нулями до целого байта, и сбрасывает буфер в файл.
  */
 void write_last(Writer *writer);
 
 /**
- * Инициализирует структуру Reader.
+ * Очищает Writer, записывающий в память, для повторного использования буфера.
+ */
+void reset_writer(Writer *writer);
+
+/**
+ * Освобождает буфер Writer.
+ */
+void delete_writer(Writer *writer);
+
+/**
+ * Инициализирует структуру Reader и выделяет её буфер.
+ */
+int init_reader(Reader *reader, FILE* input);
+
+/**
+ * Инициализирует Reader для чтения из области памяти (память не копируется).
  */
-void init_reader(Reader *reader, FILE* input);
+void init_memory_reader(Reader *reader, const unsigned char *data, size_t size);
+
+/**
+ * Дополняет аккумулятор байтами из входного потока, пока в нём есть место.
+ */
+void refill_bits(Reader *reader);
+
+/**
+ * Считывает 8 байтов как число со старшим байтом первым (одной загрузкой, где это возможно).
+ */
+ALWAYS_INLINE unsigned long long load_be64(const unsigned char *p) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    unsigned long long word;
+    memcpy(&word, p, sizeof(word));
+    return __builtin_bswap64(word);
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    unsigned long long word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+#else
+    return ((unsigned long long)p[0] << 56) | ((unsigned long long)p[1] << 48)
+        | ((unsigned long long)p[2] << 40) | ((unsigned long long)p[3] << 32)
+        | ((unsigned long long)p[4] << 24) | ((unsigned long long)p[5] << 16)
+        | ((unsigned long long)p[6] << 8) | (unsigned long long)p[7];
+#endif
+}
+
+/**
+ * Дополняет аккумулятор одним чтением 8 байтов без проверок конца данных.
+ * Допустимо только для чтения из памяти, если в аккумуляторе есть хотя бы один бит
+ * и до конца данных осталось не меньше 8 байтов; после вызова в аккумуляторе
+ * не меньше 57 битов. Горячие циклы вызывают её для локальной копии Reader,
+ * чтобы аккумулятор оставался в регистрах.
+ */
+ALWAYS_INLINE void refill_bits_fast(Reader *reader) {
+    unsigned long long word = load_be64(reader->buffer + reader->pos);
+    size_t bytes = (64 - reader->bits_filled) >> 3;
+    reader->acc = (reader->acc << (8 * bytes)) | ((word >> (63 - 8 * bytes)) >> 1);
+    reader->pos += bytes;
+    reader->bits_filled += 8 * bytes;
+}
+
+/**
+ * Возвращает следующие n битов без их потребления (n <= BITIO_MAX_BITS).
+ * За концом потока недостающие биты считаются нулевыми.
+ */
+static inline unsigned long long peek_bits(Reader *reader, size_t n) {
+    if (reader->bits_filled < n)
+        refill_bits(reader);
+    if (reader->bits_filled >= n)
+        return (reader->acc >> (reader->bits_filled - n)) & ((1ULL << n) - 1);
+    return (reader->acc << (n - reader->bits_filled)) & ((1ULL << n) - 1);
+}
+
+/**
+ * Потребляет n битов, ранее полученных через peek_bits().
+ */
+static inline void consume_bits(Reader *reader, size_t n) {
+    reader->bits_filled = (n < reader->bits_filled) ? reader->bits_filled - n : 0;
+}
+
+/**
+ * Проверяет, остались ли во входном потоке непрочитанные биты.
+ */
+int end_of_bits(Reader *reader);
 
 /**
  * Считывает один бит из входного потока.
@@ -65,3 +200,23 @@ unsigned char read_byte(Reader *reader);
  * Считывает целое число, представленное заданным количеством битов.
  */
 unsigned read_number(Reader *reader, size_t bits);
+
+/**
+ * Отбрасывает непрочитанные биты до границы байта.
+ */
+void align_reader(Reader *reader);
+
+/**
+ * Считывает до size байтов (поток должен быть выровнен по байту).
+ */
+size_t read_bytes(Reader *reader, void *data, size_t size);
+
+/**
+ * Считывает беззнаковое число в формате varint.
+ */
+int read_varint(Reader *reader, unsigned long long *value);
+
+/**
+ * Освобождает буфер Reader.
+ */
+void delete_reader(Reader *reader);
@@ -0,0 +1,231 @@
+#pragma once
+#include <stdlib.h>
+#include "bitio.h"
+#include "codes.h"
+#include "decoder.h"
+#include "histogram.h"
+
+/// Типы блоков архива.
+enum {
+    BLOCK_END = 0,          ///< Признак конца архива.
+    BLOCK_HUFFMAN = 1,      ///< Блок, сжатый кодами Хаффмана.
+    BLOCK_HUFFMAN4 = 2,     ///< Блок, сжатый кодами Хаффмана в HUFFMAN_STREAMS независимых потоков.
+    BLOCK_HUFFMAN_REUSE = 3,    ///< Как BLOCK_HUFFMAN, но с таблицей кодов предыдущего блока.
+    BLOCK_HUFFMAN4_REUSE = 4,   ///< Как BLOCK_HUFFMAN4, но с таблицей кодов предыдущего блока.
+    BLOCK_STORED = 5,       ///< Исходные данные без сжатия.
+    BLOCK_RLE = 6,          ///< Повторение одного байта: сжатые данные — этот байт.
+    BLOCK_TYPES             ///< Количество типов блоков.
+};
+
+/// Допустимая потеря при повторном использовании таблицы: 1/REUSE_TOLERANCE от оценки сжатого размера.
+enum { REUSE_TOLERANCE = 64 };
+
+/// Размер блока по умолчанию.
+enum { DEFAULT_BLOCK_SIZE = 1 << 20 };
+
+/// Минимальный размер блока.
+enum { MIN_BLOCK_SIZE = 1 << 12 };
+
+/// Максимальный размер блока (и при сжатии, и при распаковке).
+enum { MAX_BLOCK_SIZE = 1 << 26 };
+
+/// Минимальный размер блока, разбиваемого на независимые потоки.
+enum { STREAMS_MIN_SIZE = 1 << 10 };
+
+/// Размер таблицы переходов блока BLOCK_HUFFMAN4 (размеры всех потоков, кроме последнего).
+enum { JUMP_TABLE_SIZE = 4 * (HUFFMAN_STREAMS - 1) };
+
+/// Наибольший размер заголовка блока в байтах (тип и два varint).
+enum { BLOCK_HEADER_MAX_SIZE = 21 };
+
+/// Версия формата архива.
+enum { ARCHIVE_VERSION = 1 };
+
+/// Флаги заголовка архива.
+enum {
+    ARCHIVE_SIZE_KNOWN = 1,     ///< Заголовок хранит размер исходного файла.
+    ARCHIVE_INDEXED = 2         ///< После блока BLOCK_END записан индекс блоков.
+};
+
+/// Наибольший размер заголовка архива в байтах (сигнатура, версия, флаги, varint).
+enum { ARCHIVE_HEADER_MAX_SIZE = 16 };
+
+/// Размер записи индекса блоков в байтах (смещения блока, исходных данных и блока с таблицей, контрольная сумма).
+enum { INDEX_ENTRY_SIZE = 28 };
+
+/// Размер окончания индекса в байтах (смещение индекса, размер исходных данных, количество записей, сигнатура).
+enum { INDEX_TRAILER_SIZE = 24 };
+
+/**
+ * Заголовок файла архива.
+ */
+typedef struct ArchiveHeader {
+    unsigned char flags;                ///< Флаги ARCHIVE_*.
+    unsigned long long original_size;   ///< Размер исходного файла (если ARCHIVE_SIZE_KNOWN).
+} ArchiveHeader;
+
+/**
+ * Заголовок блока архива.
+ */
+typedef struct BlockHeader {
+    unsigned char type;         ///< Тип блока.
+    size_t original_size;       ///< Размер исходных данных блока.
+    size_t payload_size;        ///< Размер сжатых данных блока.
+} BlockHeader;
+
+/**
+ * Запись индекса блоков.
+ */
+typedef struct IndexEntry {
+    unsigned long long block_offset;    ///< Смещение заголовка блока в архиве.
+    unsigned long long original_offset; ///< Смещение исходных данных блока в исходном файле.
+    unsigned long long table_offset;    ///< Смещение заголовка блока, чью таблицу кодов использует блок.
+    uint32_t checksum;                  ///< Контрольная сумма исходных данных блока (block_checksum()).
+} IndexEntry;
+
+/**
+ * Окончание индекса блоков, последние INDEX_TRAILER_SIZE байтов архива.
+ */
+typedef struct IndexTrailer {
+    unsigned long long index_offset;    ///< Смещение первой записи индекса в архиве.
+    unsigned long long original_size;   ///< Размер исходного файла.
+    size_t count;                       ///< Количество записей (блоков).
+} IndexTrailer;
+
+/**
+ * Таблица кодов блока, которую может использовать следующий блок.
+ */
+typedef struct BlockTable {
+    unsigned char lengths[ALPHABET_SIZE];   ///< Длины кодов.
+    Code codes[ALPHABET_SIZE];              ///< Канонические коды.
+    size_t header_bits;                     ///< Размер записи длин кодов в битах.
+    int ready;                              ///< Флаг готовности таблицы (для ожидания в следующем блоке).
+} BlockTable;
+
+/**
+ * Записывает заголовок архива.
+ */
+void write_archive_header(Writer *output, const ArchiveHeader *header);
+
+/**
+ * Считывает и проверяет заголовок архива.
+ */
+int read_archive_header(Reader *input, ArchiveHeader *header);
+
+/**
+ * Возвращает размер заголовка архива в байтах.
+ */
+size_t archive_header_size(const ArchiveHeader *header);
+
+/**
+ * Возвращает размер блока в архиве (заголовок и сжатые данные) в байтах.
+ */
+size_t block_size_in_archive(const BlockHeader *header);
+
+/**
+ * Возвращает наибольший возможный размер сжатых данных блока.
+ */
+size_t block_payload_bound(size_t size, size_t max_length);
+
+/**
+ * Обеспечивает буферу размер не меньше size байтов.
+ */
+int reserve_buffer(unsigned char **buffer, size_t *capacity, size_t size);
+
+/**
+ * Вычисляет длины кодов Хаффмана, не превышающие max_length.
+ */
+void build_code_lengths(const unsigned long long *freq_table, size_t max_length, unsigned char *lengths);
+
+/**
+ * Проверяет, использует ли блок этого типа таблицу кодов предыдущего блока.
+ */
+int block_reuses_table(unsigned char type);
+
+/**
+ * Проверяет, записана ли в блоке этого типа своя таблица кодов.
+ */
+int block_has_table(unsigned char type);
+
+/**
+ * Решает, выгоднее ли сжать блок таблицей предыдущего блока, чем строить свою.
+ */
+int should_reuse_table(const unsigned long long *freq_table, const BlockTable *previous);
+
+/**
+ * Выбирает способ записи блока (BLOCK_RLE, BLOCK_STORED или коды Хаффмана) по оценке размера.
+ */
+unsigned char choose_block_type(const unsigned long long *freq_table, size_t size, const unsigned char *lengths,
+                                size_t header_bits);
+
+/**
+ * Записывает блок BLOCK_STORED или BLOCK_RLE и возвращает его тип.
+ */
+unsigned char encode_raw(const unsigned char *data, size_t size, unsigned char type, Writer *payload);
+
+/**
+ * Дописывает коды байтов блока после длин кодов (или без них) и возвращает тип блока.
+ */
+unsigned char encode_symbols(const unsigned char *data, size_t size, const Code *code_table, int reuse,
+                             Writer *payload);
+
+/**
+ * Записывает сжатые данные блока с готовой таблицей кодов (или без сжатия) и возвращает тип блока.
+ */
+unsigned char encode_payload(const unsigned char *data, size_t size, const unsigned long long *freq_table,
+                             const unsigned char *lengths, const Code *code_table, Writer *payload);
+
+/**
+ * Сжимает блок данных со своей таблицей кодов и возвращает тип блока.
+ */
+unsigned char encode_block(const unsigned char *data, size_t size, size_t max_length, Writer *payload);
+
+/**
+ * Записывает заголовок блока.
+ */
+void write_block_header(Writer *output, const BlockHeader *header);
+
+/**
+ * Записывает заголовок блока и его сжатые данные.
+ */
+void write_block(Writer *output, const BlockHeader *header, const unsigned char *payload);
+
+/**
+ * Записывает признак конца архива.
+ */
+void write_end_block(Writer *output);
+
+/**
+ * Вычисляет контрольную сумму исходных данных блока (Adler-32).
+ */
+uint32_t block_checksum(const unsigned char *data, size_t size);
+
+/**
+ * Записывает индекс блоков и его окончание.
+ */
+void write_index(Writer *output, const IndexEntry *entries, const IndexTrailer *trailer);
+
+/**
+ * Разбирает и проверяет окончание индекса.
+ */
+int read_index_trailer(const unsigned char *bytes, unsigned long long archive_size, IndexTrailer *trailer);
+
+/**
+ * Разбирает запись индекса.
+ */
+void read_index_entry(const unsigned char *bytes, IndexEntry *entry);
+
+/**
+ * Считывает и проверяет заголовок блока.
+ */
+int read_block_header(Reader *input, BlockHeader *header);
+
+/**
+ * Считывает длины кодов из начала сжатых данных блока и строит по ним таблицу декодирования.
+ */
+int read_block_table(const unsigned char *payload, size_t size, DecodeTable *table);
+
+/**
+ * Восстанавливает исходные данные блока.
+ */
+int decode_block(const BlockHeader *header, const unsigned char *payload, DecodeTable *table, unsigned char *out);
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "bitio.h"
+
+/// Количество различных символов (байтов).
+enum { ALPHABET_SIZE = 256 };
+
+/// Максимальная длина кода Хаффмана в битах.
+enum { MAX_CODE_LENGTH = 32 };
+
+/// Ограничение длины кода по умолчанию.
+enum { DEFAULT_CODE_LENGTH = 15 };
+
+/// Наибольший размер записи длин кодов в байтах (не больше 10 битов на символ).
+enum { CODE_LENGTHS_MAX_SIZE = (ALPHABET_SIZE * 10 + 7) / 8 };
+
+/**
+ * Код символа: биты кода, упакованные в целое число, и их количество.
+ */
+typedef struct Code {
+    uint32_t code;      ///< Биты кода (младшие len битов, старший бит пишется первым).
+    uint8_t len;        ///< Длина кода в битах.
+} Code;
+
+/**
+ * Вычисляет длины кодов Хаффмана по таблице частот (длины могут превышать MAX_CODE_LENGTH).
+ */
+void generate_code_lengths(const unsigned long long *freq_table, unsigned char *lengths);
+
+/**
+ * Возвращает длину самого длинного кода.
+ */
+size_t max_code_length(const unsigned char *lengths);
+
+/**
+ * Вычисляет оптимальные длины кодов, не превышающие max_length (алгоритм package-merge).
+ */
+void limit_code_lengths(const unsigned long long *freq_table, size_t max_length, unsigned char *lengths);
+
+/**
+ * Назначает канонические коды Хаффмана по длинам кодов.
+ */
+void generate_canonical_codes(const unsigned char *lengths, Code *code_table);
+
+/**
+ * Проверяет, что длины кодов задают полный префиксный код.
+ */
+int check_code_lengths(const unsigned char *lengths);
+
+/**
+ * Записывает длины кодов всех символов в сжатом виде.
+ */
+void write_code_lengths(Writer *writer, const unsigned char *lengths);
+
+/**
+ * Считывает длины кодов, записанные write_code_lengths().
+ */
+int read_code_lengths(Reader *reader, unsigned char *lengths);
+
+/**
+ * Записывает код символа в поток одной операцией над аккумулятором.
+ */
+static inline void write_code(Writer *writer, Code code) {
+    write_bits(writer, code.code, code.len);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <stdlib.h>
+#include "codes.h"
+#include "bitio.h"
+
+/// Максимальная разрядность первичной таблицы декодирования.
+enum { DECODE_TABLE_BITS = 11 };
+
+/// Количество независимых потоков в блоке, разбитом на потоки.
+enum { HUFFMAN_STREAMS = 4 };
+
+/// Признак листа в ссылке на потомка узла дерева (младшие биты — символ).
+enum { TREE_LEAF = 0x8000 };
+
+/// Ссылка на отсутствующего потомка (недопустимый код).
+enum { TREE_INVALID = 0xFFFF };
+
+/**
+ * Запись первичной таблицы декодирования.
+ *
+ * Если tree == 0, запись описывает символ и длину его кода.
+ * Иначе код длиннее первичной таблицы и дочитывается по дереву,
+ * начиная с узла value.
+ */
+typedef struct DecodeEntry {
+    unsigned short value;     ///< Символ или индекс узла дерева.
+    unsigned char length;     ///< Количество битов, потребляемых записью (0 — недопустимый код).
+    unsigned char tree;       ///< 1 — запись ссылается на узел дерева.
+} DecodeEntry;
+
+/**
+ * Первичная таблица для декодирования нескольких битов за одно обращение
+ * и компактное дерево для редких длинных кодов.
+ *
+ * Узлы дерева хранятся подряд в порядке обхода в ширину; узел — два 16-битных
+ * потомка, лист отмечен битом TREE_LEAF. Всё дерево занимает не больше 1 КБ.
+ */
+typedef struct DecodeTable {
+    DecodeEntry entries[1 << DECODE_TABLE_BITS];    ///< Первичная таблица (используются первые 2^root_bits записей).
+    unsigned short tree[ALPHABET_SIZE][2];          ///< Узлы дерева кодов длиннее root_bits.
+    unsigned char root_bits;                        ///< Разрядность первичной таблицы.
+    unsigned char max_length;                       ///< Длина самого длинного кода.
+} DecodeTable;
+
+/**
+ * Инициализирует пустую таблицу декодирования.
+ */
+void init_decode_table(DecodeTable *table);
+
+/**
+ * Строит таблицу декодирования по длинам канонических кодов.
+ */
+int build_decode_table(DecodeTable *table, const unsigned char *lengths);
+
+/**
+ * Декодирует ровно count символов из потока.
+ */
+size_t decode_symbols(Reader *reader, const DecodeTable *table, unsigned char *out, size_t count);
+
+/**
+ * Декодирует count символов из HUFFMAN_STREAMS потоков, продвигая их поочерёдно.
+ */
+int decode_streams(Reader *readers, const DecodeTable *table, unsigned char *out, size_t count);
+
+/**
+ * Освобождает таблицу декодирования.
+ */
+void delete_decode_table(DecodeTable *table);
@@ -0,0 +1,19 @@
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+
+/// Количество независимых банков счётчиков гистограммы.
+enum { HISTOGRAM_BANKS = 4 };
+
+/// Наибольшее количество байтов, подсчитываемых 32-битными счётчиками до их сброса.
+enum { HISTOGRAM_CHUNK = 1 << 30 };
+
+/**
+ * Добавляет к таблице частот количества байтов области памяти.
+ */
+void create_freq_table(const unsigned char *data, size_t size, unsigned long long *freq_table);
+
+/**
+ * Возвращает 1, если create_freq_table() использует векторную (AVX2) реализацию.
+ */
+int histogram_uses_simd(void);
@@ -0,0 +1,83 @@
+#pragma once
+#include <stdlib.h>
+
+/**
+ * Контекст библиотеки: таблица декодирования и буферы, переиспользуемые между вызовами.
+ *
+ * Контекст не разделяется между потоками: каждому потоку нужен свой.
+ */
+typedef struct HuffContext HuffContext;
+
+/**
+ * Создаёт контекст сжатия и распаковки.
+ */
+HuffContext* huff_create_context(void);
+
+/**
+ * Освобождает контекст и все его буферы.
+ */
+void huff_delete_context(HuffContext *context);
+
+/**
+ * Возвращает наибольший возможный размер архива для size байтов исходных данных
+ * или 0, если он не помещается в size_t.
+ */
+size_t huff_compress_bound(size_t size);
+
+/**
+ * Сжимает буфер в архив с переиспользованием буферов контекста.
+ */
+int huff_compress_with(HuffContext *context, const void *src, size_t src_size, void *dst, size_t *dst_size);
+
+/**
+ * Распаковывает архив из буфера с переиспользованием таблицы контекста.
+ */
+int huff_decompress_with(HuffContext *context, const void *src, size_t src_size, void *dst, size_t *dst_size);
+
+/**
+ * Сжимает буфер в архив (с временным контекстом).
+ */
+int huff_compress(const void *src, size_t src_size, void *dst, size_t *dst_size);
+
+/**
+ * Распаковывает архив из буфера (с временным контекстом).
+ */
+int huff_decompress(const void *src, size_t src_size, void *dst, size_t *dst_size);
+
+/**
+ * Возвращает размер исходных данных, записанный в заголовке архива.
+ */
+int huff_decompressed_size(const void *src, size_t src_size, unsigned long long *size);
+
+/// Направление потокового контекста.
+enum {
+    HUFF_STREAM_COMPRESS = 0,       ///< Сжатие.
+    HUFF_STREAM_DECOMPRESS = 1      ///< Распаковка.
+};
+
+/// Результаты huff_stream_update().
+enum {
+    HUFF_STREAM_ERROR = 0,          ///< Ошибка памяти или повреждённый архив.
+    HUFF_STREAM_OK = 1,             ///< Нужны ещё входные данные или место для выхода.
+    HUFF_STREAM_END = 2             ///< Архив полностью записан или распакован.
+};
+
+/**
+ * Потоковый контекст сжатия или распаковки данных, поступающих частями.
+ */
+typedef struct HuffStream HuffStream;
+
+/**
+ * Создаёт потоковый контекст сжатия или распаковки.
+ */
+HuffStream* huff_stream_init(int mode);
+
+/**
+ * Обрабатывает очередную порцию входа и выдаёт готовый выход (finish — вход закончился).
+ */
+int huff_stream_update(HuffStream *stream, const void *in, size_t *in_len, void *out, size_t *out_len, int finish);
+
+/**
+ * Освобождает потоковый контекст.
+ */
+void huff_stream_end(HuffStream *stream);
@@ -0,0 +1,23 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Входной файл, отображённый в память.
+ */
+typedef struct Mapping {
+    const unsigned char *data;  ///< Данные файла от текущей позиции (NULL — файл не отображён).
+    size_t size;                ///< Количество байтов от текущей позиции до конца файла.
+    void *base;                 ///< Начало отображения (для munmap).
+    size_t length;              ///< Длина отображения.
+} Mapping;
+
+/**
+ * Отображает в память остаток обычного файла, начиная с текущей позиции.
+ */
+int map_input(Mapping *mapping, FILE *file);
+
+/**
+ * Снимает отображение файла.
+ */
+void unmap_input(Mapping *mapping);
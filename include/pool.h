@@ -0,0 +1,61 @@
+#pragma once
+#include <stdlib.h>
+#include <pthread.h>
+
+/// Максимальное количество рабочих потоков.
+enum { MAX_THREADS = 256 };
+
+/**
+ * Функция, выполняемая задачей пула.
+ */
+typedef void (*TaskFunction)(void *arg);
+
+/**
+ * Задача пула потоков.
+ */
+typedef struct Task {
+    TaskFunction function;      ///< Выполняемая функция.
+    void *arg;                  ///< Аргумент функции.
+    int *done;                  ///< Флаг завершения, выставляемый после выполнения.
+} Task;
+
+/**
+ * Пул рабочих потоков с общей очередью задач.
+ */
+typedef struct Pool {
+    pthread_t *threads;         ///< Рабочие потоки.
+    size_t count;               ///< Количество рабочих потоков (0 — задачи выполняются сразу).
+    Task *tasks;                ///< Кольцевой буфер ожидающих задач.
+    size_t capacity;            ///< Размер кольцевого буфера.
+    size_t first;               ///< Индекс первой ожидающей задачи.
+    size_t length;              ///< Количество ожидающих задач.
+    int stop;                   ///< Признак завершения работы пула.
+    pthread_mutex_t lock;       ///< Мьютекс, защищающий очередь и флаги завершения.
+    pthread_cond_t available;   ///< Сигнал о появлении задачи или остановке.
+    pthread_cond_t finished;    ///< Сигнал о завершении очередной задачи.
+} Pool;
+
+/**
+ * Создаёт пул из threads рабочих потоков (при threads <= 1 задачи выполняются в вызывающем потоке).
+ */
+int init_pool(Pool *pool, size_t threads, size_t capacity);
+
+/**
+ * Ставит задачу в очередь; по завершении выставляет *done = 1.
+ */
+void submit_task(Pool *pool, TaskFunction function, void *arg, int *done);
+
+/**
+ * Выставляет флаг в 1 и будит потоки, ожидающие его в wait_task().
+ */
+void signal_flag(Pool *pool, int *flag);
+
+/**
+ * Ожидает, пока задача с флагом done не завершится.
+ */
+void wait_task(Pool *pool, int *done);
+
+/**
+ * Останавливает рабочие потоки и освобождает ресурсы пула.
+ */
+void delete_pool(Pool *pool);
@@ -0,0 +1,65 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include "codes.h"
+#include "block.h"
+
+/// Измеряемые фазы сжатия и распаковки.
+enum {
+    STATS_HISTOGRAM,        ///< Подсчёт частот байтов.
+    STATS_LENGTHS,          ///< Вычисление длин кодов.
+    STATS_CODES,            ///< Генерация канонических кодов.
+    STATS_ENCODE,           ///< Запись длин кодов и кодирование данных.
+    STATS_WRITE,            ///< Запись заголовков и сжатых блоков в файл.
+    STATS_WAIT,             ///< Ожидание таблицы предыдущего блока при сжатии.
+    STATS_DECODE,           ///< Построение таблиц и декодирование блоков.
+    STATS_PHASES
+};
+
+/**
+ * Статистика сжатия или распаковки.
+ *
+ * Время фаз суммируется по всем блокам (при нескольких потоках — по всем потокам).
+ */
+typedef struct Stats {
+    double seconds[STATS_PHASES];               ///< Суммарное время каждой фазы.
+    double wall;                                ///< Полное время работы.
+    unsigned long long original_size;           ///< Размер исходных (несжатых) данных.
+    unsigned long long archive_size;            ///< Размер архива.
+    unsigned long long blocks;                  ///< Количество блоков.
+    unsigned long long block_types[BLOCK_TYPES]; ///< Количество блоков каждого типа.
+    unsigned long long freq_table[ALPHABET_SIZE]; ///< Частоты байтов всего файла (только при сжатии).
+    double code_bits;                           ///< Сумма длин кодов всех закодированных байтов.
+    double entropy_bits;                        ///< Сумма энтропий блоков (граница Шеннона), биты.
+} Stats;
+
+/**
+ * Обнуляет статистику.
+ */
+void init_stats(Stats *stats);
+
+/**
+ * Возвращает монотонное время в секундах.
+ */
+double stats_clock(void);
+
+/**
+ * Учитывает частоты и длины кодов очередного блока с учётом способа его записи.
+ */
+void add_block_stats(Stats *stats, unsigned char type, const unsigned long long *freq_table,
+                     const unsigned char *lengths);
+
+/**
+ * Учитывает записанный или прочитанный блок в счётчиках блоков.
+ */
+void count_block(Stats *stats, unsigned char type);
+
+/**
+ * Прибавляет статистику part к total.
+ */
+void merge_stats(Stats *total, const Stats *part);
+
+/**
+ * Выводит статистику в текстовом виде или в формате JSON.
+ */
+void print_stats(const Stats *stats, char mode, int json, FILE *output);
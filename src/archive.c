@@ -0,0 +1,980 @@
+#include "archive.h"
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+void init_options(Options *options) {
+    /**
+     * @brief Заполняет параметры сжатия и распаковки значениями по умолчанию.
+     *
+     * @param options Указатель на параметры.
+     */
+    options->max_code_length = DEFAULT_CODE_LENGTH;
+    options->block_size = DEFAULT_BLOCK_SIZE;
+    options->threads = 1;
+    options->index = 0;
+    options->reuse_tables = 1;
+    options->stats = NULL;
+}
+
+static void describe_input(FILE *input, const Mapping *mapping, ArchiveHeader *header) {
+    /**
+     * @brief Заполняет заголовок архива размером входного файла, если он известен.
+     *
+     * Размер известен для отображённого и любого обычного файла;
+     * для каналов флаг ARCHIVE_SIZE_KNOWN не выставляется.
+     *
+     * @param input Входной файл.
+     * @param mapping Отображение входного файла (data == NULL — не отображён).
+     * @param header Заполняемый заголовок архива.
+     */
+    header->flags = 0;
+    header->original_size = 0;
+    if (mapping->data) {
+        header->flags = ARCHIVE_SIZE_KNOWN;
+        header->original_size = mapping->size;
+        return;
+    }
+#ifndef _WIN32
+    struct stat info;
+    off_t pos = ftello(input);
+    if (pos >= 0 && fstat(fileno(input), &info) == 0 && S_ISREG(info.st_mode) && info.st_size >= pos) {
+        header->flags = ARCHIVE_SIZE_KNOWN;
+        header->original_size = (unsigned long long)(info.st_size - pos);
+    }
+#else
+    (void)input;
+#endif
+}
+
+static int add_block_size(const ArchiveHeader *archive, unsigned long long *total, size_t size) {
+    /**
+     * @brief Учитывает размер очередного блока в общем размере распакованных данных.
+     *
+     * Позволяет отклонить повреждённый архив до распаковки блока,
+     * если блоки выходят за размер, записанный в заголовке.
+     *
+     * @param archive Заголовок архива.
+     * @param total Общий размер предыдущих блоков.
+     * @param size Размер очередного блока.
+     * @return 1 - если размер не превышает заявленного; 0 - иначе.
+     */
+    *total += size;
+    return !(archive->flags & ARCHIVE_SIZE_KNOWN) || *total <= archive->original_size;
+}
+
+static int check_total_size(const ArchiveHeader *archive, unsigned long long total) {
+    /**
+     * @brief Проверяет, что распакованы все данные, записанные в заголовке.
+     *
+     * @param archive Заголовок архива.
+     * @param total Общий размер всех блоков.
+     * @return 1 - если размер совпадает или неизвестен; 0 - если архив оборван.
+     */
+    return !(archive->flags & ARCHIVE_SIZE_KNOWN) || total == archive->original_size;
+}
+
+/**
+ * Задание на сжатие одного блока рабочим потоком.
+ */
+typedef struct EncodeJob {
+    const unsigned char *data;  ///< Исходные данные блока (в buffer или в отображённом файле).
+    unsigned char *buffer;      ///< Буфер размера block_size (NULL, если вход отображён в память).
+    size_t size;                ///< Размер исходных данных.
+    size_t max_code_length;     ///< Максимальная длина кода.
+    int index;                  ///< 1 - вычислять контрольную сумму блока для индекса.
+    Pool *pool;                 ///< Пул, через который ожидается таблица предыдущего блока.
+    BlockTable *table;          ///< Таблица кодов этого блока.
+    BlockTable *previous;       ///< Таблица предыдущего блока (NULL — всегда строить свою).
+    uint32_t checksum;          ///< Контрольная сумма исходных данных блока.
+    unsigned char type;         ///< Тип сжатого блока.
+    Writer payload;             ///< Сжатые данные блока.
+    Stats stats;                ///< Время фаз и частоты этого блока.
+    int done;                   ///< Флаг завершения задания.
+} EncodeJob;
+
+static void inherit_table(BlockTable *table, const BlockTable *previous) {
+    /**
+     * @brief Копирует в таблицу задания таблицу предыдущего блока.
+     *
+     * Без предыдущей таблицы длины кодов обнуляются: такую таблицу
+     * should_reuse_table() не выберет ни для одного блока.
+     *
+     * @param table Таблица задания.
+     * @param previous Таблица предыдущего блока (может быть NULL).
+     */
+    if (!previous) {
+        memset(table->lengths, 0, sizeof(table->lengths));
+        table->header_bits = 0;
+        return;
+    }
+    memcpy(table->lengths, previous->lengths, sizeof(table->lengths));
+    memcpy(table->codes, previous->codes, sizeof(table->codes));
+    table->header_bits = previous->header_bits;
+}
+
+static void encode_job(void *arg) {
+    /**
+     * @brief Сжимает блок задания (выполняется рабочим потоком).
+     *
+     * Делает то же, что encode_block(), но замеряет время каждой фазы
+     * и сохраняет частоты и длины кодов блока в статистике задания.
+     *
+     * После подсчёта частот ждёт таблицу предыдущего блока и, если она
+     * подходит (should_reuse_table()), кодирует ей, не строя свою и не
+     * записывая длины кодов. Своя или унаследованная таблица публикуется
+     * для следующего блока до кодирования данных, поэтому блоки
+     * по-прежнему кодируются параллельно. Блок, записываемый без кодов
+     * Хаффмана (choose_block_type()), своей таблицы в архив не пишет
+     * и передаёт дальше таблицу предыдущего блока.
+     *
+     * @param arg Указатель на EncodeJob.
+     */
+    EncodeJob *job = (EncodeJob*)arg;
+    Stats *stats = &job->stats;
+    BlockTable *table = job->table;
+    init_stats(stats);
+
+    double start = stats_clock();
+    unsigned long long freq_table[ALPHABET_SIZE] = { 0 };
+    create_freq_table(job->data, job->size, freq_table);
+    double histogram_end = stats_clock();
+
+    int reuse = 0;
+    double wait_end = histogram_end;
+    if (job->previous) {
+        wait_task(job->pool, &job->previous->ready);
+        wait_end = stats_clock();
+        reuse = should_reuse_table(freq_table, job->previous);
+    }
+    if (reuse)
+        inherit_table(table, job->previous);
+    else
+        build_code_lengths(freq_table, job->max_code_length, table->lengths);
+    double lengths_end = stats_clock();
+
+    if (!reuse) {
+        generate_canonical_codes(table->lengths, table->codes);
+        reset_writer(&job->payload);
+        write_code_lengths(&job->payload, table->lengths);
+        table->header_bits = 8 * job->payload.pos + job->payload.bits_filled;
+    }
+    double codes_end = stats_clock();
+
+    job->type = choose_block_type(freq_table, job->size, table->lengths, reuse ? 0 : table->header_bits);
+    add_block_stats(stats, job->type, freq_table, table->lengths);
+    if (!reuse && job->type != BLOCK_HUFFMAN)
+        inherit_table(table, job->previous);
+    signal_flag(job->pool, &table->ready);
+    if (job->type == BLOCK_HUFFMAN)
+        job->type = encode_symbols(job->data, job->size, table->codes, reuse, &job->payload);
+    else
+        encode_raw(job->data, job->size, job->type, &job->payload);
+    if (job->index)
+        job->checksum = block_checksum(job->data, job->size);
+    stats->seconds[STATS_HISTOGRAM] = histogram_end - start;
+    stats->seconds[STATS_WAIT] = wait_end - histogram_end;
+    stats->seconds[STATS_LENGTHS] = lengths_end - wait_end;
+    stats->seconds[STATS_CODES] = codes_end - lengths_end;
+    stats->seconds[STATS_ENCODE] = stats_clock() - codes_end;
+}
+
+static size_t read_block(FILE *input, unsigned char *buffer, size_t size) {
+    /**
+     * @brief Считывает очередной блок, пока он не заполнится или не кончится файл.
+     *
+     * fread из канала может вернуть меньше запрошенного до конца данных,
+     * поэтому чтение повторяется.
+     *
+     * @param input Входной файл.
+     * @param buffer Буфер блока.
+     * @param size Размер блока.
+     * @return Количество прочитанных байтов; 0 - в конце файла.
+     */
+    size_t filled = 0;
+    while (filled < size) {
+        size_t read = fread(buffer + filled, sizeof(char), size - filled, input);
+        if (read == 0)
+            break;
+        filled += read;
+    }
+    return filled;
+}
+
+int compress_archive(FILE *input, FILE *output, const Options *options) {
+    /**
+     * @brief Сжимает входной файл поблочно.
+     *
+     * Файл читается блоками по options->block_size байтов; каждый блок
+     * получает свою таблицу частот и свои коды и записывается вместе
+     * с исходным и сжатым размером. Архив начинается заголовком с размером
+     * исходного файла (если он известен) и завершается блоком BLOCK_END.
+     * Входной файл читается один раз и не перематывается. Обычный файл
+     * отображается в память (map_input), и блоки сжимаются прямо из неё
+     * без копирования; каналы читаются через fread.
+     *
+     * Блоки сжимаются параллельно пулом из options->threads потоков:
+     * основной поток читает блоки в кольцо из 2 * threads заданий (при одном
+     * потоке — ровно один блок в памяти) и
+     * записывает готовые блоки строго по порядку, поэтому архив не зависит
+     * от количества потоков. Таблицы кодов блоков лежат в кольце из 2 * slots
+     * элементов, поэтому таблица блока не перезаписывается, пока её ещё может
+     * читать следующий блок.
+     *
+     * С options->index после BLOCK_END дописывается индекс блоков (write_index()):
+     * смещения блоков в архиве и в исходном файле и контрольные суммы, —
+     * по которому extract_archive() находит нужные блоки без чтения всего архива.
+     *
+     * @param input Входной файл.
+     * @param output Выходной файл.
+     * @param options Параметры сжатия (если options->stats задан, статистика прибавляется к нему).
+     * @return 1 - при успехе; 0 - при ошибке выделения памяти или записи
+     * (в том числе если размер входного файла изменился во время сжатия).
+     */
+    Mapping mapping;
+    int mapped = map_input(&mapping, input);
+    size_t mapped_offset = 0;
+    ArchiveHeader archive;
+    describe_input(input, &mapping, &archive);
+    if (options->index)
+        archive.flags |= ARCHIVE_INDEXED;
+    IndexEntry *index = NULL;
+    size_t index_capacity = 0;
+
+    size_t slots = (options->threads > 1) ? 2 * options->threads : 1;
+    Pool pool;
+    EncodeJob *jobs = (EncodeJob*)calloc(slots, sizeof(EncodeJob));
+    BlockTable *tables = (BlockTable*)calloc(2 * slots, sizeof(BlockTable));
+    size_t ready = 0;
+    int ok = jobs && tables;
+    for (; ok && ready < slots; ready++) {
+        jobs[ready].buffer = mapped ? NULL : (unsigned char*)malloc(options->block_size);
+        jobs[ready].max_code_length = options->max_code_length;
+        jobs[ready].index = options->index;
+        jobs[ready].pool = &pool;
+        if ((!mapped && !jobs[ready].buffer)
+            || !init_memory_writer(&jobs[ready].payload, options->block_size + BITIO_BUFFER_SIZE)) {
+            free(jobs[ready].buffer);
+            ok = 0;
+            break;
+        }
+    }
+
+    Writer writer;
+    int pool_started = ok;
+    int writer_ready = ok && init_writer(&writer, output);
+    ok = writer_ready && init_pool(&pool, options->threads, slots);
+
+    if (ok) {
+        size_t submitted = 0, written = 0;
+        unsigned long long total = 0, table_offset = 0;
+        int input_end = 0;
+        Stats stats;
+        init_stats(&stats);
+        write_archive_header(&writer, &archive);
+        stats.archive_size = archive_header_size(&archive);
+        for (;;) {
+            while (ok && !input_end && submitted - written < slots) {
+                EncodeJob *job = &jobs[submitted % slots];
+                if (mapped) {
+                    size_t rest = mapping.size - mapped_offset;
+                    job->size = (rest < options->block_size) ? rest : options->block_size;
+                    job->data = mapping.data + mapped_offset;
+                    mapped_offset += job->size;
+                }
+                else {
+                    job->size = read_block(input, job->buffer, options->block_size);
+                    job->data = job->buffer;
+                }
+                if (job->size == 0) {
+                    input_end = 1;
+                    break;
+                }
+                job->table = &tables[submitted % (2 * slots)];
+                job->table->ready = 0;
+                job->previous = (options->reuse_tables && submitted > 0)
+                    ? &tables[(submitted - 1) % (2 * slots)] : NULL;
+                submit_task(&pool, encode_job, job, &job->done);
+                submitted++;
+            }
+            if (written == submitted)
+                break;
+
+            EncodeJob *job = &jobs[written % slots];
+            wait_task(&pool, &job->done);
+            BlockHeader header;
+            header.type = job->type;
+            header.original_size = job->size;
+            header.payload_size = job->payload.pos;
+            if (ok && options->index && written == index_capacity) {
+                size_t capacity = index_capacity ? 2 * index_capacity : 64;
+                IndexEntry *grown = (IndexEntry*)realloc(index, capacity * sizeof(IndexEntry));
+                ok = grown != NULL;
+                if (grown) {
+                    index = grown;
+                    index_capacity = capacity;
+                }
+            }
+            if (block_has_table(header.type))
+                table_offset = stats.archive_size;
+            if (ok && options->index) {
+                index[written].block_offset = stats.archive_size;
+                index[written].original_offset = total;
+                index[written].table_offset = table_offset;
+                index[written].checksum = job->checksum;
+            }
+            double start = stats_clock();
+            write_block(&writer, &header, job->payload.buffer);
+            stats.seconds[STATS_WRITE] += stats_clock() - start;
+            merge_stats(&stats, &job->stats);
+            stats.archive_size += block_size_in_archive(&header);
+            count_block(&stats, header.type);
+            ok = ok && !job->payload.error && !writer.error;
+            total += job->size;
+            written++;
+        }
+        double start = stats_clock();
+        write_end_block(&writer);
+        stats.archive_size++;
+        if (options->index && ok) {
+            IndexTrailer trailer = { stats.archive_size, total, written };
+            write_index(&writer, index, &trailer);
+            stats.archive_size += written * INDEX_ENTRY_SIZE + INDEX_TRAILER_SIZE;
+        }
+        write_last(&writer);
+        stats.seconds[STATS_WRITE] += stats_clock() - start;
+        stats.original_size = total;
+        ok = ok && !writer.error && check_total_size(&archive, total);
+        if (options->stats)
+            merge_stats(options->stats, &stats);
+    }
+
+    if (pool_started && writer_ready)
+        delete_pool(&pool);
+    if (writer_ready)
+        delete_writer(&writer);
+    for (size_t i = 0; i < ready; i++) {
+        free(jobs[i].buffer);
+        delete_writer(&jobs[i].payload);
+    }
+    free(jobs);
+    free(tables);
+    free(index);
+    unmap_input(&mapping);
+    return ok;
+}
+
+static void add_decoded_block(Stats *stats, const BlockHeader *header, double seconds) {
+    /**
+     * @brief Учитывает распакованный блок в статистике.
+     *
+     * @param stats Статистика распаковки.
+     * @param header Заголовок блока.
+     * @param seconds Время декодирования блока.
+     */
+    stats->seconds[STATS_DECODE] += seconds;
+    stats->original_size += header->original_size;
+    stats->archive_size += block_size_in_archive(header);
+    count_block(stats, header->type);
+}
+
+#ifndef _WIN32
+/**
+ * Положение блока в архиве и в распакованном файле.
+ */
+typedef struct BlockEntry {
+    BlockHeader header;         ///< Заголовок блока.
+    off_t payload_offset;       ///< Смещение сжатых данных в архиве.
+    off_t original_offset;      ///< Смещение исходных данных в распакованном файле.
+    off_t table_offset;         ///< Смещение сжатых данных блока с таблицей кодов (для блоков *_REUSE).
+    size_t table_size;          ///< Размер сжатых данных блока с таблицей кодов.
+} BlockEntry;
+
+/**
+ * Задание на распаковку одного блока рабочим потоком.
+ */
+typedef struct DecodeJob {
+    const BlockEntry *entry;    ///< Распаковываемый блок.
+    const unsigned char *mapped; ///< Начало архива, отображённого в память (NULL — чтение через pread).
+    int input_fd;               ///< Дескриптор архива.
+    int output_fd;              ///< Дескриптор распакованного файла.
+    off_t output_offset;        ///< Позиция выходного файла, с которой начинаются распакованные данные.
+    unsigned char *payload;     ///< Буфер сжатых данных.
+    size_t payload_capacity;    ///< Размер буфера сжатых данных.
+    unsigned char *out;         ///< Буфер исходных данных.
+    size_t out_capacity;        ///< Размер буфера исходных данных.
+    DecodeTable table;          ///< Таблица декодирования, переиспользуемая заданиями этого слота.
+    off_t table_offset;         ///< Смещение сжатых данных блока, по которому построена table (-1 — никакого).
+    double seconds;             ///< Время декодирования блока.
+    int ok;                     ///< Признак успешной распаковки.
+    int done;                   ///< Флаг завершения задания.
+} DecodeJob;
+
+static int is_regular_file(FILE *file) {
+    /**
+     * @brief Проверяет, что файл обычный (допускает позиционный ввод-вывод).
+     *
+     * @param file Открытый файл.
+     * @return 1 - для обычного файла; 0 - для канала, терминала и т.п.
+     */
+    struct stat info;
+    return fstat(fileno(file), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+static int is_positional_output(FILE *file) {
+    /**
+     * @brief Проверяет, что в файл можно писать через pwrite.
+     *
+     * Файл должен быть обычным и открытым без O_APPEND: в режиме
+     * дозаписи pwrite игнорирует смещение и дописывает в конец.
+     *
+     * @param file Открытый выходной файл.
+     * @return 1 - если запись по смещениям допустима; 0 - иначе.
+     */
+    int flags = fcntl(fileno(file), F_GETFL);
+    return is_regular_file(file) && flags != -1 && !(flags & O_APPEND);
+}
+
+static size_t read_at(int fd, void *data, size_t size, off_t offset) {
+    /**
+     * @brief Считывает до size байтов по смещению offset через pread.
+     *
+     * @param fd Дескриптор файла.
+     * @param data Буфер.
+     * @param size Количество байтов.
+     * @param offset Смещение в файле.
+     * @return Количество прочитанных байтов; меньше size - в конце файла или при ошибке.
+     */
+    size_t done = 0;
+    while (done < size) {
+        ssize_t read = pread(fd, (unsigned char*)data + done, size - done, offset + (off_t)done);
+        if (read <= 0)
+            break;
+        done += (size_t)read;
+    }
+    return done;
+}
+
+static int scan_blocks(FILE *input, const ArchiveHeader *archive, BlockEntry **entries, size_t *count, off_t *total) {
+    /**
+     * @brief Составляет список блоков архива, не читая их сжатые данные.
+     *
+     * Читает только заголовки и перепрыгивает сжатые данные через fseeko,
+     * попутно вычисляя смещение каждого блока в распакованном файле.
+     * Для блоков *_REUSE запоминает, где лежат длины кодов их таблицы.
+     * Блок, выходящий за конец архива или за размер из заголовка архива,
+     * а также блок *_REUSE без предшествующей таблицы считается повреждением — список блоков не растёт сверх того,
+     * что допускает заголовок.
+     *
+     * @param input Входной файл архива (обычный файл).
+     * @param archive Заголовок архива.
+     * @param entries Указатель для массива блоков (освобождает вызывающий).
+     * @param count Указатель для количества блоков.
+     * @param total Указатель для размера распакованного файла.
+     * @return 1 - при успехе; 0 - если архив повреждён или не хватило памяти.
+     */
+    struct stat info;
+    off_t pos = ftello(input);
+    off_t table_offset = -1;
+    size_t table_size = 0, capacity = 0;
+    *entries = NULL;
+    *count = 0;
+    *total = 0;
+    if (pos < 0 || fstat(fileno(input), &info) != 0)
+        return 0;
+
+    for (;;) {
+        unsigned char bytes[BLOCK_HEADER_MAX_SIZE];
+        if (fseeko(input, pos, SEEK_SET) != 0)
+            return 0;
+        Reader reader;
+        init_memory_reader(&reader, bytes, fread(bytes, sizeof(char), sizeof(bytes), input));
+        BlockHeader header;
+        if (!read_block_header(&reader, &header))
+            return 0;
+        if (header.type == BLOCK_END)
+            return 1;
+
+        unsigned long long size = (unsigned long long)*total;
+        if (!add_block_size(archive, &size, header.original_size))
+            return 0;
+
+        BlockEntry entry;
+        entry.header = header;
+        entry.payload_offset = pos + (off_t)(reader.pos - reader.bits_filled / 8);
+        entry.original_offset = *total;
+        if (entry.payload_offset + (off_t)header.payload_size > info.st_size)
+            return 0;
+        if (block_has_table(header.type)) {
+            table_offset = entry.payload_offset;
+            table_size = header.payload_size;
+        }
+        else if (block_reuses_table(header.type) && table_offset < 0)
+            return 0;
+        entry.table_offset = table_offset;
+        entry.table_size = table_size;
+
+        if (*count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            BlockEntry *grown = (BlockEntry*)realloc(*entries, capacity * sizeof(BlockEntry));
+            if (!grown)
+                return 0;
+            *entries = grown;
+        }
+        (*entries)[(*count)++] = entry;
+        *total += (off_t)header.original_size;
+        pos = entry.payload_offset + (off_t)header.payload_size;
+    }
+}
+
+static void decode_job(void *arg) {
+    /**
+     * @brief Распаковывает блок задания (выполняется рабочим потоком).
+     *
+     * Берёт сжатые данные из отображённого архива (или читает их через pread)
+     * и записывает результат через pwrite по заранее известному смещению,
+     * поэтому блоки завершаются в любом порядке. Для блока *_REUSE таблица
+     * строится по длинам кодов блока, которому она принадлежит, если слот
+     * не построил её раньше.
+     *
+     * @param arg Указатель на DecodeJob.
+     */
+    DecodeJob *job = (DecodeJob*)arg;
+    const BlockHeader *header = &job->entry->header;
+    job->ok = (job->mapped || reserve_buffer(&job->payload, &job->payload_capacity, header->payload_size))
+        && reserve_buffer(&job->out, &job->out_capacity, header->original_size);
+    const unsigned char *payload = job->mapped ? job->mapped + job->entry->payload_offset : job->payload;
+
+    for (size_t done = 0; job->ok && !job->mapped && done < header->payload_size; ) {
+        ssize_t read = pread(job->input_fd, job->payload + done, header->payload_size - done,
+                             job->entry->payload_offset + (off_t)done);
+        job->ok = read > 0;
+        done += (read > 0) ? (size_t)read : 0;
+    }
+    double start = stats_clock();
+    int reuse = block_reuses_table(header->type);
+    if (job->ok && reuse && job->table_offset != job->entry->table_offset) {
+        unsigned char bytes[CODE_LENGTHS_MAX_SIZE];
+        size_t size = (job->entry->table_size < sizeof(bytes)) ? job->entry->table_size : sizeof(bytes);
+        const unsigned char *lengths = job->mapped ? job->mapped + job->entry->table_offset : bytes;
+        job->ok = (job->mapped || read_at(job->input_fd, bytes, size, job->entry->table_offset) == size)
+            && read_block_table(lengths, size, &job->table);
+    }
+    job->ok = job->ok && decode_block(header, payload, &job->table, job->out);
+    if (!job->ok)
+        job->table_offset = -1;
+    else if (block_has_table(header->type))
+        job->table_offset = job->entry->payload_offset;
+    else if (reuse)
+        job->table_offset = job->entry->table_offset;
+    job->seconds = stats_clock() - start;
+    for (size_t done = 0; job->ok && done < header->original_size; ) {
+        ssize_t written = pwrite(job->output_fd, job->out + done, header->original_size - done,
+                                 job->output_offset + job->entry->original_offset + (off_t)done);
+        job->ok = written > 0;
+        done += (written > 0) ? (size_t)written : 0;
+    }
+}
+
+static int read_file_header(FILE *input, ArchiveHeader *archive) {
+    /**
+     * @brief Считывает заголовок архива и ставит позицию файла сразу за ним.
+     *
+     * @param input Входной файл архива (обычный файл).
+     * @param archive Структура для записи заголовка.
+     * @return 1 - при успехе; 0 - если заголовок повреждён.
+     */
+    unsigned char bytes[ARCHIVE_HEADER_MAX_SIZE];
+    off_t pos = ftello(input);
+    Reader reader;
+    init_memory_reader(&reader, bytes, fread(bytes, sizeof(char), sizeof(bytes), input));
+    return pos >= 0 && read_archive_header(&reader, archive)
+        && fseeko(input, pos + (off_t)(reader.pos - reader.bits_filled / 8), SEEK_SET) == 0;
+}
+
+static int decompress_parallel(FILE *input, FILE *output, const Mapping *mapping, size_t threads, Stats *stats) {
+    /**
+     * @brief Распаковывает архив параллельно пулом рабочих потоков.
+     *
+     * Сначала составляет список блоков, сверяет их общий размер с заголовком
+     * архива и задаёт размер выходного файла, затем каждый блок распаковывается независимо прямо в свою область файла.
+     * В работе одновременно не больше 2 * threads блоков. Данные пишутся
+     * с текущей позиции выходного файла (он может быть stdout, в который
+     * уже что-то записано), после распаковки позиция ставится за ними.
+     *
+     * @param input Входной файл архива (обычный файл).
+     * @param output Выходной файл (обычный файл без O_APPEND).
+     * @param mapping Отображение архива в память (base == NULL — читать через pread).
+     * @param threads Количество рабочих потоков.
+     * @param stats Статистика распаковки.
+     * @return 1 - при успехе; 0 - если архив повреждён, не хватило памяти или произошла ошибка записи.
+     */
+    BlockEntry *entries = NULL;
+    size_t count = 0;
+    off_t total = 0;
+    ArchiveHeader archive = { 0, 0 };
+    off_t base = -1;
+    int ok = read_file_header(input, &archive) && scan_blocks(input, &archive, &entries, &count, &total)
+        && check_total_size(&archive, (unsigned long long)total)
+        && fflush(output) == 0 && (base = ftello(output)) >= 0 && ftruncate(fileno(output), base + total) == 0;
+
+    size_t slots = 2 * threads;
+    DecodeJob *jobs = ok ? (DecodeJob*)calloc(slots, sizeof(DecodeJob)) : NULL;
+    for (size_t i = 0; jobs && i < slots; i++) {
+        init_decode_table(&jobs[i].table);
+        jobs[i].table_offset = -1;
+    }
+    Pool pool;
+    if (jobs && init_pool(&pool, threads, slots)) {
+        for (size_t i = 0; i < count + slots; i++) {
+            DecodeJob *job = &jobs[i % slots];
+            if (i >= slots) {
+                wait_task(&pool, &job->done);
+                ok = ok && job->ok;
+                if (ok)
+                    add_decoded_block(stats, &job->entry->header, job->seconds);
+            }
+            if (i < count && ok) {
+                job->entry = &entries[i];
+                job->mapped = (const unsigned char*)mapping->base;
+                job->input_fd = fileno(input);
+                job->output_fd = fileno(output);
+                job->output_offset = base;
+                submit_task(&pool, decode_job, job, &job->done);
+            }
+            else job->done = 1;
+        }
+    }
+    else ok = 0;
+    stats->archive_size += archive_header_size(&archive) + 1;
+    if (jobs) {
+        delete_pool(&pool);
+        for (size_t i = 0; i < slots; i++) {
+            free(jobs[i].payload);
+            free(jobs[i].out);
+            delete_decode_table(&jobs[i].table);
+        }
+    }
+    free(jobs);
+    free(entries);
+    return ok && fseeko(output, base + total, SEEK_SET) == 0;
+}
+#endif
+
+static int decompress_mapped(const Mapping *mapping, FILE *output, Stats *stats) {
+    /**
+     * @brief Последовательно распаковывает архив, отображённый в память.
+     *
+     * Сжатые данные блоков декодируются прямо из отображения, без копирования.
+     *
+     * @param mapping Отображение архива в память.
+     * @param output Выходной файл.
+     * @param stats Статистика распаковки.
+     * @return 1 - при успехе; 0 - если архив повреждён, не хватило памяти или произошла ошибка записи.
+     */
+    unsigned char *out = NULL;
+    size_t out_capacity = 0, offset = 0;
+    unsigned long long total = 0;
+    Reader reader;
+    ArchiveHeader archive;
+    BlockHeader header;
+    DecodeTable table;
+    init_decode_table(&table);
+    init_memory_reader(&reader, mapping->data, mapping->size);
+    int ok = read_archive_header(&reader, &archive);
+    while (ok && (ok = read_block_header(&reader, &header)) && header.type != BLOCK_END) {
+        offset += reader.pos - reader.bits_filled / 8;
+        ok = add_block_size(&archive, &total, header.original_size)
+            && header.payload_size <= mapping->size - offset
+            && reserve_buffer(&out, &out_capacity, header.original_size);
+        double start = stats_clock();
+        ok = ok && decode_block(&header, mapping->data + offset, &table, out);
+        add_decoded_block(stats, &header, stats_clock() - start);
+        ok = ok && fwrite(out, sizeof(char), header.original_size, output) == header.original_size;
+        if (!ok)
+            break;
+        offset += header.payload_size;
+        init_memory_reader(&reader, mapping->data + offset, mapping->size - offset);
+    }
+    free(out);
+    delete_decode_table(&table);
+    stats->archive_size += archive_header_size(&archive) + 1;
+    return ok && check_total_size(&archive, total);
+}
+
+static int decompress_buffered(FILE *input, FILE *output, Stats *stats) {
+    /**
+     * @brief Последовательно распаковывает архив, читая его через буферизованный Reader.
+     *
+     * @param input Входной файл архива (в том числе канал).
+     * @param output Выходной файл.
+     * @param stats Статистика распаковки.
+     * @return 1 - при успехе; 0 - если архив повреждён, не хватило памяти или произошла ошибка записи.
+     */
+    Reader reader;
+    if (!init_reader(&reader, input))
+        return 0;
+
+    unsigned char *payload = NULL;
+    unsigned char *out = NULL;
+    size_t payload_capacity = 0, out_capacity = 0;
+    unsigned long long total = 0;
+    ArchiveHeader archive;
+    BlockHeader header;
+    DecodeTable table;
+    init_decode_table(&table);
+    int ok = read_archive_header(&reader, &archive);
+
+    while (ok && (ok = read_block_header(&reader, &header)) && header.type != BLOCK_END) {
+        ok = add_block_size(&archive, &total, header.original_size)
+            && reserve_buffer(&payload, &payload_capacity, header.payload_size)
+            && reserve_buffer(&out, &out_capacity, header.original_size)
+            && read_bytes(&reader, payload, header.payload_size) == header.payload_size;
+        double start = stats_clock();
+        ok = ok && decode_block(&header, payload, &table, out);
+        add_decoded_block(stats, &header, stats_clock() - start);
+        ok = ok && fwrite(out, sizeof(char), header.original_size, output) == header.original_size;
+        if (!ok)
+            break;
+    }
+
+    free(payload);
+    free(out);
+    delete_decode_table(&table);
+    delete_reader(&reader);
+    stats->archive_size += archive_header_size(&archive) + 1;
+    return ok && check_total_size(&archive, total);
+}
+
+int decompress_archive(FILE *input, FILE *output, const Options *options) {
+    /**
+     * @brief Распаковывает архив поблочно.
+     *
+     * Для каждого блока читает заголовок и сжатые данные, восстанавливает
+     * исходные данные и записывает их. Архив без заголовка, с блоками сверх
+     * записанного в заголовке размера или оборванный раньше него отклоняется.
+     * Если задано несколько потоков, оба файла обычные и выходной файл открыт
+     * не в режиме дозаписи, блоки распаковываются параллельно
+     * (decompress_parallel); иначе — последовательно.
+     * Обычный файл архива отображается в память (map_input), и сжатые данные
+     * читаются прямо из неё; каналы читаются через буферизованный Reader.
+     *
+     * @param input Входной файл архива.
+     * @param output Выходной файл.
+     * @param options Параметры распаковки (если options->stats задан, статистика прибавляется к нему).
+     * @return 1 - при успехе; 0 - если архив повреждён или не хватило памяти.
+     */
+    Stats stats;
+    init_stats(&stats);
+    Mapping mapping;
+    int mapped = map_input(&mapping, input);
+    int result;
+#ifndef _WIN32
+    if (options->threads > 1 && is_regular_file(input) && is_positional_output(output))
+        result = decompress_parallel(input, output, &mapping, options->threads, &stats);
+    else
+#endif
+    if (mapped)
+        result = decompress_mapped(&mapping, output, &stats);
+    else
+        result = decompress_buffered(input, output, &stats);
+    unmap_input(&mapping);
+    if (options->stats)
+        merge_stats(options->stats, &stats);
+    return result;
+}
+
+#ifndef _WIN32
+static int find_indexed_block(int fd, off_t base, off_t archive_size, unsigned long long offset,
+                              unsigned char **index, IndexTrailer *trailer, size_t *first) {
+    /**
+     * @brief Считывает индекс блоков и находит блок, содержащий байт offset.
+     *
+     * Записи индекса упорядочены по смещению исходных данных, поэтому
+     * нужный блок ищется двоичным поиском.
+     *
+     * @param fd Дескриптор файла с архивом.
+     * @param base Смещение начала архива в файле.
+     * @param archive_size Размер архива.
+     * @param offset Смещение в исходном файле.
+     * @param index Указатель для записей индекса (освобождает вызывающий).
+     * @param trailer Окончание индекса.
+     * @param first Указатель для номера найденного блока.
+     * @return 1 - при успехе; 0 - если индекс повреждён или не хватило памяти.
+     */
+    unsigned char bytes[INDEX_TRAILER_SIZE];
+    if (archive_size < INDEX_TRAILER_SIZE
+        || read_at(fd, bytes, sizeof(bytes), base + archive_size - INDEX_TRAILER_SIZE) != sizeof(bytes)
+        || !read_index_trailer(bytes, (unsigned long long)archive_size, trailer))
+        return 0;
+    size_t size = trailer->count * INDEX_ENTRY_SIZE;
+    *index = (unsigned char*)malloc(size ? size : 1);
+    if (!*index || read_at(fd, *index, size, base + (off_t)trailer->index_offset) != size)
+        return 0;
+
+    size_t low = 0, high = trailer->count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        IndexEntry entry;
+        read_index_entry(*index + middle * INDEX_ENTRY_SIZE, &entry);
+        if (entry.original_offset <= offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    *first = low ? low - 1 : 0;
+    return 1;
+}
+
+static int read_table_at(int fd, off_t block_offset, DecodeTable *table) {
+    /**
+     * @brief Строит таблицу декодирования по длинам кодов блока с явной таблицей.
+     *
+     * Читается только заголовок блока и начало его сжатых данных.
+     *
+     * @param fd Дескриптор файла с архивом.
+     * @param block_offset Смещение заголовка блока в файле.
+     * @param table Таблица декодирования.
+     * @return 1 - при успехе; 0 - если по смещению нет блока с явной таблицей.
+     */
+    unsigned char bytes[BLOCK_HEADER_MAX_SIZE + CODE_LENGTHS_MAX_SIZE];
+    size_t size = read_at(fd, bytes, sizeof(bytes), block_offset);
+    Reader reader;
+    BlockHeader header;
+    init_memory_reader(&reader, bytes, size);
+    if (!read_block_header(&reader, &header) || !block_has_table(header.type))
+        return 0;
+    size_t start = reader.pos - reader.bits_filled / 8;
+    if (header.payload_size < size - start)
+        size = start + header.payload_size;
+    return read_block_table(bytes + start, size - start, table);
+}
+#endif
+
+int extract_archive(FILE *input, FILE *output, unsigned long long offset, unsigned long long length,
+                    const Options *options) {
+    /**
+     * @brief Распаковывает из архива только байты [offset, offset + length) исходного файла.
+     *
+     * Архив, как и в decompress_archive(), начинается с текущей позиции input
+     * и продолжается до конца файла; смещения индекса отсчитываются от его начала.
+     * Распаковываются лишь блоки, пересекающие диапазон. Если у архива есть
+     * индекс (ARCHIVE_INDEXED), первый такой блок находится по нему одним
+     * чтением, а контрольная сумма каждого распакованного блока сверяется
+     * с индексом. Иначе предшествующие блоки перепрыгиваются по заголовкам
+     * без чтения их сжатых данных. Блок *_REUSE декодируется по таблице
+     * блока, указанного в индексе (или последнего пройденного блока
+     * с явной таблицей). Диапазон, выходящий за конец файла, обрезается.
+     * В статистику попадают только распакованные блоки.
+     *
+     * @param input Входной файл архива (обычный файл).
+     * @param output Выходной файл.
+     * @param offset Смещение первого байта в исходном файле.
+     * @param length Количество байтов.
+     * @param options Параметры (если options->stats задан, статистика прибавляется к нему).
+     * @return 1 - при успехе; 0 - если архив повреждён, offset за концом файла,
+     * архив не обычный файл или не хватило памяти.
+     */
+#ifndef _WIN32
+    struct stat info;
+    int fd = fileno(input);
+    off_t base = ftello(input);
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || base < 0 || base > info.st_size)
+        return 0;
+
+    Stats stats;
+    init_stats(&stats);
+    unsigned char bytes[BLOCK_HEADER_MAX_SIZE];
+    Reader reader;
+    ArchiveHeader archive;
+    init_memory_reader(&reader, bytes, read_at(fd, bytes, ARCHIVE_HEADER_MAX_SIZE, base));
+    if (!read_archive_header(&reader, &archive))
+        return 0;
+    off_t pos = (off_t)(reader.pos - reader.bits_filled / 8);
+    unsigned long long original_offset = 0;
+
+    unsigned char *index = NULL;
+    IndexTrailer trailer;
+    size_t block = 0;
+    int indexed = (archive.flags & ARCHIVE_INDEXED) != 0;
+    int ok = !indexed || find_indexed_block(fd, base, info.st_size - base, offset, &index, &trailer, &block);
+    if (ok && indexed && trailer.count > 0) {
+        IndexEntry entry;
+        read_index_entry(index + block * INDEX_ENTRY_SIZE, &entry);
+        pos = (off_t)entry.block_offset;
+        original_offset = entry.original_offset;
+    }
+
+    unsigned long long end = (length > ~0ULL - offset) ? ~0ULL : offset + length;
+    unsigned char *payload = NULL, *out = NULL;
+    size_t payload_capacity = 0, out_capacity = 0;
+    DecodeTable table;
+    init_decode_table(&table);
+    off_t table_block = -1, built = -1;
+    int finished = 0;
+    for (; ok && original_offset < end; block++) {
+        BlockHeader header;
+        init_memory_reader(&reader, bytes, read_at(fd, bytes, sizeof(bytes), base + pos));
+        ok = read_block_header(&reader, &header);
+        if (!ok || header.type == BLOCK_END) {
+            finished = 1;
+            break;
+        }
+        off_t payload_offset = pos + (off_t)(reader.pos - reader.bits_filled / 8);
+        int reuse = block_reuses_table(header.type), owner = block_has_table(header.type);
+        IndexEntry entry;
+        if (indexed) {
+            ok = block < trailer.count;
+            if (ok)
+                read_index_entry(index + block * INDEX_ENTRY_SIZE, &entry);
+            ok = ok && entry.block_offset == (unsigned long long)pos && entry.original_offset == original_offset
+                && (owner ? entry.table_offset == entry.block_offset
+                          : !reuse || entry.table_offset < entry.block_offset);
+            if (owner || reuse)
+                table_block = (off_t)entry.table_offset;
+        }
+        else if (owner)
+            table_block = pos;
+        ok = ok && (!reuse || table_block >= 0);
+        if (ok && original_offset + header.original_size > offset) {
+            size_t from = (offset > original_offset) ? (size_t)(offset - original_offset) : 0;
+            size_t to = (end - original_offset < header.original_size) ? (size_t)(end - original_offset)
+                                                                       : header.original_size;
+            ok = reserve_buffer(&payload, &payload_capacity, header.payload_size)
+                && reserve_buffer(&out, &out_capacity, header.original_size)
+                && read_at(fd, payload, header.payload_size, base + payload_offset) == header.payload_size;
+            double start = stats_clock();
+            ok = ok && (!reuse || built == table_block || read_table_at(fd, base + table_block, &table))
+                && decode_block(&header, payload, &table, out);
+            double seconds = stats_clock() - start;
+            ok = ok && (!indexed || block_checksum(out, header.original_size) == entry.checksum)
+                && fwrite(out + from, sizeof(char), to - from, output) == to - from;
+            if (owner || reuse)
+                built = ok ? table_block : -1;
+            if (ok)
+                add_decoded_block(&stats, &header, seconds);
+        }
+        original_offset += header.original_size;
+        pos = payload_offset + (off_t)header.payload_size;
+    }
+    free(payload);
+    free(out);
+    free(index);
+    delete_decode_table(&table);
+    if (options->stats)
+        merge_stats(options->stats, &stats);
+    if ((archive.flags & ARCHIVE_SIZE_KNOWN) && original_offset > archive.original_size)
+        return 0;
+    return ok && !(finished && offset > original_offset);
+#else
+    (void)input;
+    (void)output;
+    (void)offset;
+    (void)length;
+    (void)options;
+    return 0;
+#endif
+}
@@ -1,149 +1,337 @@
+#include <string.h>
 #include "bitio.h"
 
-void init_writer(Writer *writer, FILE* output) {
+int init_writer(Writer *writer, FILE* output) {
     /**
      * @brief Инициализирует структуру Writer.
      *
-     * Устанавливает выходной поток и сбрасывает буфер записи.
+     * Устанавливает выходной поток, сбрасывает аккумулятор и выделяет буфер.
      *
      * @param writer Указатель на структуру Writer.
      * @param output Указатель на открытый файл для записи битов.
+     * @return 1 - при успехе, 0 - при ошибке выделения памяти.
      */
     writer->output = output;
-    writer->byte = 0;
+    writer->acc = 0;
     writer->bits_filled = 0;
+    writer->pos = 0;
+    writer->error = 0;
+    writer->capacity = BITIO_BUFFER_SIZE;
+    writer->buffer = (unsigned char*)malloc(writer->capacity);
+    return writer->buffer != NULL;
 }
 
-void write_bit(Writer *writer, unsigned char bit) {
+int init_memory_writer(Writer *writer, size_t capacity) {
+    /**
+     * @brief Инициализирует Writer для записи в память.
+     *
+     * Записанные байты остаются в writer->buffer[0..pos); при нехватке места
+     * буфер увеличивается.
+     *
+     * @param writer Указатель на структуру Writer.
+     * @param capacity Начальный размер буфера.
+     * @return 1 - при успехе, 0 - при ошибке выделения памяти.
+     */
+    if (init_writer(writer, NULL) && capacity > writer->capacity) {
+        unsigned char *buffer = (unsigned char*)realloc(writer->buffer, capacity);
+        if (!buffer) {
+            free(writer->buffer);
+            writer->buffer = NULL;
+            return 0;
+        }
+        writer->buffer = buffer;
+        writer->capacity = capacity;
+    }
+    return writer->buffer != NULL;
+}
+
+static void make_room(Writer *writer, size_t size) {
     /**
-     * @brief Записывает один бит в буфер Writer.
+     * @brief Освобождает в буфере место для size байтов.
      *
-     * Когда буфер накапливает 8 бит, он сбрасывается в файл.
+     * При записи в файл буфер сбрасывается через fwrite, при записи
+     * в память — увеличивается. При ошибке выставляется writer->error,
+     * а накопленные байты отбрасываются.
      *
      * @param writer Указатель на Writer.
-     * @param bit Бит для записи (только младший значащий бит учитывается).
+     * @param size Необходимое количество свободных байтов (не больше размера буфера для файла).
      */
-    writer->byte <<= 1;
-    writer->byte += (bit & 1);
-    writer->bits_filled++;
-    if (writer->bits_filled == 8) {
-        fputc(writer->byte, writer->output);
-        writer->byte = 0;
-        writer->bits_filled = 0;
+    if (writer->output) {
+        if (fwrite(writer->buffer, sizeof(char), writer->pos, writer->output) != writer->pos)
+            writer->error = 1;
+        writer->pos = 0;
+        return;
+    }
+    size_t capacity = writer->capacity;
+    while (capacity < writer->pos + size)
+        capacity *= 2;
+    unsigned char *buffer = (unsigned char*)realloc(writer->buffer, capacity);
+    if (buffer) {
+        writer->buffer = buffer;
+        writer->capacity = capacity;
+    }
+    else {
+        writer->error = 1;
+        writer->pos = 0;
+    }
+}
+
+void flush_bits(Writer *writer) {
+    /**
+     * @brief Переносит целые байты из аккумулятора в буфер.
+     *
+     * Буфер сбрасывается в файл одним вызовом fwrite (или растёт при записи
+     * в память), когда в нём не остаётся места для содержимого аккумулятора.
+     *
+     * @param writer Указатель на Writer.
+     */
+    if (writer->pos + 8 > writer->capacity)
+        make_room(writer, 8);
+    while (writer->bits_filled >= 8) {
+        writer->bits_filled -= 8;
+        writer->buffer[writer->pos++] = (unsigned char)(writer->acc >> writer->bits_filled);
     }
 }
 
+void write_bit(Writer *writer, unsigned char bit) {
+    /**
+     * @brief Записывает один бит.
+     *
+     * @param writer Указатель на Writer.
+     * @param bit Бит для записи (только младший значащий бит учитывается).
+     */
+    write_bits(writer, bit, 1);
+}
+
 void write_byte(Writer *writer, unsigned char byte) {
     /**
      * @brief Записывает байт с учётом состояния Writer.
      *
-     * Если буфер Writer пуст - байт записывается напрямую.
-     * Иначе данные сливаются побитово с текущим байтом в буфере.
+     * Байт не обязан быть выровнен: его биты дописываются в аккумулятор.
      *
      * @param writer Указатель на Writer.
      * @param byte Байт для записи.
      */
-    if (writer->bits_filled == 0) {
-        fputc(byte, writer->output);
-    }
-    else {
-        size_t shift = 8 - writer->bits_filled;
-        writer->byte <<= shift;
-        writer->byte += (byte >> writer->bits_filled);
-        fputc(writer->byte, writer->output);
-        writer->byte = (byte << shift) >> shift;
-    }
+    write_bits(writer, byte, 8);
 }
 
 void write_number(Writer *writer, unsigned number, size_t bits) {
     /**
-     * @brief Записывает число побитно.
-     *
-     * Число разбивается на отдельные биты (старший бит первым) и записывается по одному.
+     * @brief Записывает число, начиная со старшего бита.
      *
      * @param writer Указатель на Writer.
      * @param number Число для записи.
      * @param bits Количество бит, используемых для записи.
      */
-    for (int j = (int)(bits - 1); j >= 0; j--) {
-        write_bit(writer, (number >> j) & 1);
+    write_bits(writer, number, bits);
+}
+
+void write_bytes(Writer *writer, const void *data, size_t size) {
+    /**
+     * @brief Записывает последовательность байтов.
+     *
+     * Поток должен быть выровнен по байту. Большие блоки при записи в файл
+     * передаются в fwrite напрямую, минуя буфер.
+     *
+     * @param writer Указатель на Writer.
+     * @param data Записываемые байты.
+     * @param size Количество байтов.
+     */
+    flush_bits(writer);
+    if (writer->pos + size > writer->capacity)
+        make_room(writer, size);
+    if (writer->output && size > writer->capacity) {
+        if (fwrite(data, sizeof(char), size, writer->output) != size)
+            writer->error = 1;
+        return;
+    }
+    if (writer->pos + size <= writer->capacity) {
+        memcpy(writer->buffer + writer->pos, data, size);
+        writer->pos += size;
+    }
+}
+
+void write_varint(Writer *writer, unsigned long long value) {
+    /**
+     * @brief Записывает беззнаковое число в формате varint.
+     *
+     * Число записывается группами по 7 битов, начиная с младших;
+     * старший бит каждого байта означает, что за ним следует продолжение.
+     *
+     * @param writer Указатель на Writer.
+     * @param value Записываемое число.
+     */
+    while (value >= 0x80) {
+        write_bits(writer, (value & 0x7F) | 0x80, 8);
+        value >>= 7;
+    }
+    write_bits(writer, value, 8);
+}
+
+size_t varint_size(unsigned long long value) {
+    /**
+     * @brief Возвращает количество байтов, которое write_varint() потратит на число.
+     *
+     * @param value Число.
+     * @return Размер в байтах (от 1 до 10).
+     */
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
     }
+    return size;
 }
 
 void write_last(Writer *writer) {
     /**
      * @brief Завершает побитовую запись.
      *
-     * Если в буфере остались биты, дополняет до целого байта нулями и записывает.
+     * Если в аккумуляторе остались биты, дополняет их до целого байта нулями.
+     * При записи в файл затем сбрасывает весь буфер; при записи в память
+     * результат остаётся в буфере.
      *
      * @param writer Указатель на Writer.
      */
+    flush_bits(writer);
     if (writer->bits_filled != 0) {
-        writer->byte <<= (8 - writer->bits_filled);
-        fputc(writer->byte, writer->output);
-        writer->byte = writer->bits_filled;
-        writer->byte = 0;
+        writer->buffer[writer->pos++] = (unsigned char)(writer->acc << (8 - writer->bits_filled));
         writer->bits_filled = 0;
     }
+    writer->acc = 0;
+    if (writer->output) {
+        if (fwrite(writer->buffer, sizeof(char), writer->pos, writer->output) != writer->pos)
+            writer->error = 1;
+        writer->pos = 0;
+    }
+}
+
+void reset_writer(Writer *writer) {
+    /**
+     * @brief Очищает Writer для повторного использования буфера.
+     *
+     * @param writer Указатель на Writer.
+     */
+    writer->acc = 0;
+    writer->bits_filled = 0;
+    writer->pos = 0;
+    writer->error = 0;
 }
 
-void init_reader(Reader *reader, FILE* input) {
+void delete_writer(Writer *writer) {
+    /**
+     * @brief Освобождает буфер Writer.
+     *
+     * Незаписанные данные теряются, поэтому перед вызовом нужен write_last().
+     *
+     * @param writer Указатель на Writer.
+     */
+    free(writer->buffer);
+    writer->buffer = NULL;
+    writer->pos = 0;
+}
+
+int init_reader(Reader *reader, FILE* input) {
     /**
      * @brief Инициализирует структуру Reader.
      *
-     * Подготавливает Reader для побитового чтения из файла.
+     * Подготавливает Reader для побитового чтения из файла и выделяет буфер.
      *
      * @param reader Указатель на Reader.
      * @param input Указатель на открытый файл для чтения.
+     * @return 1 - при успехе, 0 - при ошибке выделения памяти.
      */
     reader->input = input;
-    reader->byte = 0;
-    reader->buf = fgetc(reader->input);
+    reader->acc = 0;
+    reader->bits_filled = 0;
+    reader->pos = 0;
+    reader->size = 0;
+    reader->eof = 0;
+    reader->buffer = (unsigned char*)malloc(BITIO_BUFFER_SIZE);
+    return reader->buffer != NULL;
+}
+
+void init_memory_reader(Reader *reader, const unsigned char *data, size_t size) {
+    /**
+     * @brief Инициализирует Reader для чтения из области памяти.
+     *
+     * Память не копируется и должна оставаться доступной до конца чтения.
+     *
+     * @param reader Указатель на Reader.
+     * @param data Начало области памяти.
+     * @param size Размер области памяти.
+     */
+    reader->input = NULL;
+    reader->acc = 0;
     reader->bits_filled = 0;
+    reader->buffer = (unsigned char*)data;
+    reader->pos = 0;
+    reader->size = size;
+    reader->eof = 0;
+}
+
+void refill_bits(Reader *reader) {
+    /**
+     * @brief Дополняет аккумулятор целыми байтами, пока в нём есть место.
+     *
+     * При опустошении буфера читает следующую порцию файла через fread
+     * (при чтении из памяти — отмечает конец данных).
+     * После вызова в аккумуляторе больше 56 битов, либо входной файл исчерпан.
+     *
+     * @param reader Указатель на Reader.
+     */
+    while (reader->bits_filled <= 56) {
+        if (reader->pos == reader->size) {
+            if (reader->eof || !reader->input) {
+                reader->eof = 1;
+                return;
+            }
+            reader->size = fread(reader->buffer, sizeof(char), BITIO_BUFFER_SIZE, reader->input);
+            reader->pos = 0;
+            if (reader->size == 0) {
+                reader->eof = 1;
+                return;
+            }
+        }
+        reader->acc = (reader->acc << 8) | reader->buffer[reader->pos++];
+        reader->bits_filled += 8;
+    }
+}
+
+int end_of_bits(Reader *reader) {
+    /**
+     * @brief Проверяет, остались ли непрочитанные биты.
+     *
+     * @param reader Указатель на Reader.
+     * @return 1 - если входной поток исчерпан; 0 - иначе.
+     */
+    if (reader->bits_filled == 0)
+        refill_bits(reader);
+    return (reader->bits_filled == 0) ? 1 : 0;
 }
 
 unsigned char read_bit(Reader *reader) {
     /**
      * @brief Считывает один бит из Reader.
      *
-     * Загружает новый байт из входа, если нужно.
-     *
      * @param reader Указатель на Reader.
      * @return Прочитанный бит (0 или 1).
      */
-    if (reader->bits_filled == 0) {
-        reader->byte = reader->buf;
-        reader->buf = fgetc(reader->input);
-        reader->bits_filled = 8;
-    }
-    unsigned char bit = (reader->byte >> 7) & 1;
-    reader->byte <<= 1;
-    reader->bits_filled--;
+    unsigned char bit = (unsigned char)peek_bits(reader, 1);
+    consume_bits(reader, 1);
     return bit;
 }
 
 unsigned char read_byte(Reader *reader) {
     /**
-     * @brief Считывает один байт из Reader.
-     *
-     * Если буфер выровнен - возвращает байт напрямую.
-     * Иначе собирает байт из двух фрагментов.
+     * @brief Считывает один байт из Reader (не обязательно выровненный).
      *
      * @param reader Указатель на Reader.
      * @return Прочитанный байт.
      */
-    if (reader->bits_filled == 0) {
-        unsigned char tmp = reader->buf;
-        reader->buf = fgetc(reader->input);
-        return tmp;
-    }
-    else {
-        reader->byte += (reader->buf >> reader->bits_filled);
-        unsigned char tmp = reader->byte;
-        reader->byte = reader->buf << (8 - reader->bits_filled);
-        reader->buf = fgetc(reader->input);
-        return tmp;
-    }
+    unsigned char byte = (unsigned char)peek_bits(reader, 8);
+    consume_bits(reader, 8);
+    return byte;
 }
 
 unsigned read_number(Reader *reader, size_t bits) {
@@ -156,10 +344,102 @@ unsigned read_number(Reader *reader, size_t bits) {
      * @param bits Количество бит для считывания.
      * @return Прочитанное число.
      */
-    unsigned result = 0;
-    for (size_t i = 0; i < bits; i++) {
-        result <<= 1;
-        result += read_bit(reader);
-    }
+    unsigned result = (unsigned)peek_bits(reader, bits);
+    consume_bits(reader, bits);
     return result;
 }
+
+void align_reader(Reader *reader) {
+    /**
+     * @brief Отбрасывает непрочитанные биты до границы байта.
+     *
+     * @param reader Указатель на Reader.
+     */
+    consume_bits(reader, reader->bits_filled % 8);
+}
+
+size_t read_bytes(Reader *reader, void *data, size_t size) {
+    /**
+     * @brief Считывает до size байтов.
+     *
+     * Сначала выбираются целые байты из аккумулятора, затем — из буфера;
+     * большие блоки читаются из файла напрямую, минуя буфер.
+     *
+     * @param reader Указатель на Reader (выровненный по байту).
+     * @param data Буфер для прочитанных байтов.
+     * @param size Количество байтов.
+     * @return Количество фактически прочитанных байтов.
+     */
+    unsigned char *out = (unsigned char*)data;
+    size_t done = 0;
+    align_reader(reader);
+    while (done < size && reader->bits_filled >= 8) {
+        out[done++] = (unsigned char)peek_bits(reader, 8);
+        consume_bits(reader, 8);
+    }
+    while (done < size) {
+        if (reader->pos == reader->size) {
+            if (reader->eof || !reader->input)
+                break;
+            if (size - done >= BITIO_BUFFER_SIZE) {
+                size_t read = fread(out + done, sizeof(char), size - done, reader->input);
+                done += read;
+                if (read == 0)
+                    reader->eof = 1;
+                continue;
+            }
+            reader->size = fread(reader->buffer, sizeof(char), BITIO_BUFFER_SIZE, reader->input);
+            reader->pos = 0;
+            if (reader->size == 0) {
+                reader->eof = 1;
+                break;
+            }
+        }
+        size_t chunk = reader->size - reader->pos;
+        if (chunk > size - done)
+            chunk = size - done;
+        memcpy(out + done, reader->buffer + reader->pos, chunk);
+        reader->pos += chunk;
+        done += chunk;
+    }
+    return done;
+}
+
+int read_varint(Reader *reader, unsigned long long *value) {
+    /**
+     * @brief Считывает беззнаковое число в формате varint.
+     *
+     * @param reader Указатель на Reader.
+     * @param value Указатель для записи числа.
+     * @return 1 - при успехе; 0 - если поток оборвался или число не помещается в 64 бита
+     *         (десятый байт больше 1 или с битом продолжения).
+     */
+    unsigned long long result = 0;
+    for (size_t shift = 0; shift < 64; shift += 7) {
+        if (end_of_bits(reader))
+            return 0;
+        unsigned char byte = read_byte(reader);
+        if (shift == 63 && byte > 1)
+            return 0;
+        result |= (unsigned long long)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void delete_reader(Reader *reader) {
+    /**
+     * @brief Освобождает буфер Reader.
+     *
+     * Память, переданная в init_memory_reader(), не освобождается.
+     *
+     * @param reader Указатель на Reader.
+     */
+    if (reader->input)
+        free(reader->buffer);
+    reader->buffer = NULL;
+    reader->pos = reader->size = 0;
+}
@@ -0,0 +1,625 @@
+#include <math.h>
+#include "block.h"
+
+/// Сигнатура в начале файла архива.
+static const unsigned char ARCHIVE_MAGIC[4] = { 'H', 'U', 'F', 0x1A };
+
+/// Сигнатура в конце индекса блоков.
+static const unsigned char INDEX_MAGIC[4] = { 'H', 'I', 'D', 'X' };
+
+void write_archive_header(Writer *output, const ArchiveHeader *header) {
+    /**
+     * @brief Записывает заголовок архива.
+     *
+     * Заголовок: сигнатура, байт версии, байт флагов и, если размер исходного
+     * файла известен (ARCHIVE_SIZE_KNOWN), его varint. При сжатии из канала
+     * размер заранее неизвестен, и флаг не выставляется.
+     *
+     * @param output Writer выходного файла.
+     * @param header Заголовок архива.
+     */
+    write_bytes(output, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    write_byte(output, ARCHIVE_VERSION);
+    write_byte(output, header->flags);
+    if (header->flags & ARCHIVE_SIZE_KNOWN)
+        write_varint(output, header->original_size);
+}
+
+int read_archive_header(Reader *input, ArchiveHeader *header) {
+    /**
+     * @brief Считывает и проверяет заголовок архива.
+     *
+     * Отклоняет файлы без сигнатуры, другие версии формата и неизвестные флаги.
+     *
+     * @param input Reader входного файла (выровненный по байту).
+     * @param header Структура для записи заголовка.
+     * @return 1 - если заголовок прочитан и корректен; 0 - иначе.
+     */
+    unsigned char magic[sizeof(ARCHIVE_MAGIC)];
+    header->flags = 0;
+    header->original_size = 0;
+    if (read_bytes(input, magic, sizeof(magic)) != sizeof(magic)
+        || memcmp(magic, ARCHIVE_MAGIC, sizeof(magic)) != 0)
+        return 0;
+    if (end_of_bits(input) || read_byte(input) != ARCHIVE_VERSION || end_of_bits(input))
+        return 0;
+    header->flags = read_byte(input);
+    if (header->flags & ~(ARCHIVE_SIZE_KNOWN | ARCHIVE_INDEXED))
+        return 0;
+    return !(header->flags & ARCHIVE_SIZE_KNOWN) || read_varint(input, &header->original_size);
+}
+
+size_t archive_header_size(const ArchiveHeader *header) {
+    /**
+     * @brief Возвращает размер заголовка архива в байтах.
+     *
+     * @param header Заголовок архива.
+     * @return Размер, записываемый write_archive_header().
+     */
+    size_t size = sizeof(ARCHIVE_MAGIC) + 2;
+    if (header->flags & ARCHIVE_SIZE_KNOWN)
+        size += varint_size(header->original_size);
+    return size;
+}
+
+size_t block_size_in_archive(const BlockHeader *header) {
+    /**
+     * @brief Возвращает размер блока в архиве (заголовок и сжатые данные) в байтах.
+     *
+     * @param header Заголовок блока.
+     * @return Размер, записываемый write_block() (1 байт для BLOCK_END).
+     */
+    if (header->type == BLOCK_END)
+        return 1;
+    return 1 + varint_size(header->original_size) + varint_size(header->payload_size) + header->payload_size;
+}
+
+size_t block_payload_bound(size_t size, size_t max_length) {
+    /**
+     * @brief Возвращает наибольший возможный размер сжатых данных блока.
+     *
+     * Длины кодов занимают не более 10 битов на символ алфавита,
+     * каждый байт кодируется не более чем max_length битами;
+     * к этому добавляются таблица переходов и выравнивание потоков.
+     *
+     * @param size Размер исходных данных блока.
+     * @param max_length Максимальная длина кода (MAX_CODE_LENGTH — для любого архива).
+     * @return Верхняя граница размера сжатых данных.
+     */
+    return CODE_LENGTHS_MAX_SIZE + (size / 8) * max_length + max_length
+        + JUMP_TABLE_SIZE + HUFFMAN_STREAMS;
+}
+
+int reserve_buffer(unsigned char **buffer, size_t *capacity, size_t size) {
+    /**
+     * @brief Обеспечивает буферу размер не меньше size байтов.
+     *
+     * @param buffer Указатель на буфер (может быть NULL).
+     * @param capacity Текущий размер буфера.
+     * @param size Необходимый размер.
+     * @return 1 - при успехе; 0 - при ошибке выделения памяти.
+     */
+    if (size <= *capacity && *buffer)
+        return 1;
+    free(*buffer);
+    *buffer = (unsigned char*)malloc(size ? size : 1);
+    *capacity = *buffer ? size : 0;
+    return *buffer != NULL;
+}
+
+static void put_u32(unsigned char *bytes, size_t value) {
+    /**
+     * @brief Записывает 32-битное число в порядке little-endian.
+     *
+     * @param bytes Указатель на 4 байта.
+     * @param value Записываемое число.
+     */
+    for (size_t i = 0; i < 4; i++)
+        bytes[i] = (unsigned char)(value >> (8 * i));
+}
+
+static void put_u64(unsigned char *bytes, unsigned long long value) {
+    /**
+     * @brief Записывает 64-битное число в порядке little-endian.
+     *
+     * @param bytes Указатель на 8 байтов.
+     * @param value Записываемое число.
+     */
+    for (size_t i = 0; i < 8; i++)
+        bytes[i] = (unsigned char)(value >> (8 * i));
+}
+
+static unsigned long long get_u64(const unsigned char *bytes) {
+    /**
+     * @brief Считывает 64-битное число в порядке little-endian.
+     *
+     * @param bytes Указатель на 8 байтов.
+     * @return Считанное число.
+     */
+    unsigned long long value = 0;
+    for (size_t i = 8; i-- > 0; )
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+static size_t get_u32(const unsigned char *bytes) {
+    /**
+     * @brief Считывает 32-битное число в порядке little-endian.
+     *
+     * @param bytes Указатель на 4 байта.
+     * @return Считанное число.
+     */
+    size_t value = 0;
+    for (size_t i = 4; i-- > 0; )
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+void build_code_lengths(const unsigned long long *freq_table, size_t max_length, unsigned char *lengths) {
+    /**
+     * @brief Вычисляет длины кодов Хаффмана, не превышающие max_length.
+     *
+     * Обычно хватает generate_code_lengths(); package-merge запускается,
+     * только если самый длинный код оказался длиннее max_length.
+     *
+     * @param freq_table Массив частот символов.
+     * @param max_length Максимальная длина кода.
+     * @param lengths Выходной массив из ALPHABET_SIZE длин кодов.
+     */
+    generate_code_lengths(freq_table, lengths);
+    if (max_code_length(lengths) > max_length)
+        limit_code_lengths(freq_table, max_length, lengths);
+}
+
+int block_reuses_table(unsigned char type) {
+    /**
+     * @brief Проверяет, использует ли блок таблицу кодов предыдущего блока.
+     *
+     * @param type Тип блока.
+     * @return 1 - для BLOCK_HUFFMAN_REUSE и BLOCK_HUFFMAN4_REUSE; 0 - иначе.
+     */
+    return type == BLOCK_HUFFMAN_REUSE || type == BLOCK_HUFFMAN4_REUSE;
+}
+
+int block_has_table(unsigned char type) {
+    /**
+     * @brief Проверяет, записана ли в блоке своя таблица кодов.
+     *
+     * Только такие блоки могут дать таблицу блокам *_REUSE; блоки
+     * BLOCK_STORED и BLOCK_RLE таблицы не меняют.
+     *
+     * @param type Тип блока.
+     * @return 1 - для BLOCK_HUFFMAN и BLOCK_HUFFMAN4; 0 - иначе.
+     */
+    return type == BLOCK_HUFFMAN || type == BLOCK_HUFFMAN4;
+}
+
+int should_reuse_table(const unsigned long long *freq_table, const BlockTable *previous) {
+    /**
+     * @brief Решает, выгоднее ли сжать блок таблицей предыдущего блока.
+     *
+     * Размер блока с чужой таблицей считается точно: сумма частот, умноженных
+     * на длины кодов. Своя таблица не строится: её размер оценивается снизу
+     * энтропией блока и одним битом на байт (короче кода не бывает).
+     * Таблица переиспользуется, если потеря не больше 1/REUSE_TOLERANCE
+     * от этой оценки плюс сэкономленная запись длин кодов.
+     *
+     * @param freq_table Частоты байтов блока.
+     * @param previous Таблица предыдущего блока.
+     * @return 1 - если таблицу стоит переиспользовать; 0 - если нужна своя
+     * (в том числе если в чужой таблице нет кода для какого-либо байта).
+     */
+    unsigned long long total = 0;
+    double reused_bits = 0;
+    for (size_t i = 0; i < ALPHABET_SIZE; i++) {
+        if (freq_table[i] == 0)
+            continue;
+        if (previous->lengths[i] == 0)
+            return 0;
+        total += freq_table[i];
+        reused_bits += (double)freq_table[i] * previous->lengths[i];
+    }
+    double entropy_bits = 0;
+    for (size_t i = 0; i < ALPHABET_SIZE; i++)
+        if (freq_table[i] != 0)
+            entropy_bits -= (double)freq_table[i] * log2((double)freq_table[i] / (double)total);
+    double bound = (entropy_bits > (double)total) ? entropy_bits : (double)total;
+    return reused_bits <= bound + bound / REUSE_TOLERANCE + (double)previous->header_bits;
+}
+
+unsigned char choose_block_type(const unsigned long long *freq_table, size_t size, const unsigned char *lengths,
+                                size_t header_bits) {
+    /**
+     * @brief Выбирает способ записи блока по оценке размера сжатых данных.
+     *
+     * Блок из одного повторяющегося байта записывается как BLOCK_RLE.
+     * Размер блока в кодах Хаффмана считается по частотам сверху (с учётом
+     * выравнивания потоков и таблицы переходов); если он не меньше исходного,
+     * блок записывается без сжатия (BLOCK_STORED). Поэтому сжатые данные
+     * никогда не длиннее исходных.
+     *
+     * @param freq_table Частоты байтов блока.
+     * @param size Размер блока (больше 0).
+     * @param lengths Длины кодов, которыми будет сжат блок.
+     * @param header_bits Размер записи длин кодов в битах (0 — таблица не записывается).
+     * @return BLOCK_RLE, BLOCK_STORED или BLOCK_HUFFMAN — сжимать кодами
+     * Хаффмана (точный тип возвращает encode_symbols()).
+     */
+    unsigned long long bits = 0;
+    for (size_t i = 0; i < ALPHABET_SIZE; i++) {
+        if (freq_table[i] == size)
+            return BLOCK_RLE;
+        bits += freq_table[i] * lengths[i];
+    }
+    unsigned long long bytes;
+    if (size < STREAMS_MIN_SIZE)
+        bytes = (header_bits + bits + 7) / 8;
+    else
+        bytes = (header_bits + 7) / 8 + JUMP_TABLE_SIZE + (bits + 7) / 8 + HUFFMAN_STREAMS - 1;
+    return (bytes < size) ? BLOCK_HUFFMAN : BLOCK_STORED;
+}
+
+unsigned char encode_raw(const unsigned char *data, size_t size, unsigned char type, Writer *payload) {
+    /**
+     * @brief Записывает блок без кодов Хаффмана.
+     *
+     * BLOCK_STORED копирует исходные данные, BLOCK_RLE записывает
+     * единственный байт блока: количество повторений хранится в заголовке.
+     *
+     * @param data Исходные данные блока.
+     * @param size Размер блока (больше 0).
+     * @param type BLOCK_STORED или BLOCK_RLE (choose_block_type()).
+     * @param payload Writer, записывающий в память; очищается перед записью.
+     * @return Тип блока.
+     */
+    reset_writer(payload);
+    write_bytes(payload, data, (type == BLOCK_RLE) ? 1 : size);
+    return type;
+}
+
+unsigned char encode_symbols(const unsigned char *data, size_t size, const Code *code_table, int reuse,
+                             Writer *payload) {
+    /**
+     * @brief Дописывает коды всех байтов блока.
+     *
+     * Пишет после длин кодов, уже записанных в payload, или — если reuse —
+     * в очищенный payload без длин: тогда декодер берёт таблицу предыдущего блока.
+     * Последний байт дополняется нулями: количество символов хранится в заголовке.
+     *
+     * Блоки не меньше STREAMS_MIN_SIZE делятся на HUFFMAN_STREAMS равных отрезков,
+     * каждый из которых кодируется той же таблицей в отдельный поток,
+     * выровненный по байту. После длин кодов (тоже выровненных) идёт таблица
+     * переходов — размеры всех потоков, кроме последнего, по 4 байта, —
+     * затем сами потоки. Потоки декодируются независимо (decode_streams).
+     *
+     * @param data Исходные данные блока.
+     * @param size Размер блока (больше 0).
+     * @param code_table Канонические коды (у каждого байта блока код непустой).
+     * @param reuse 1 - таблица предыдущего блока, длины кодов не записываются.
+     * @param payload Writer, записывающий в память.
+     * @return Тип блока.
+     */
+    if (reuse)
+        reset_writer(payload);
+    if (size < STREAMS_MIN_SIZE) {
+        for (size_t i = 0; i < size; i++)
+            write_code(payload, code_table[data[i]]);
+        write_last(payload);
+        return reuse ? BLOCK_HUFFMAN_REUSE : BLOCK_HUFFMAN;
+    }
+
+    write_last(payload);
+    size_t jump_table = payload->pos;
+    unsigned char jumps[JUMP_TABLE_SIZE] = { 0 };
+    write_bytes(payload, jumps, JUMP_TABLE_SIZE);
+
+    size_t segment = (size + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+    for (size_t k = 0; k < HUFFMAN_STREAMS; k++) {
+        size_t start = payload->pos;
+        size_t end = (k + 1) * segment < size ? (k + 1) * segment : size;
+        for (size_t i = k * segment; i < end; i++)
+            write_code(payload, code_table[data[i]]);
+        write_last(payload);
+        if (k + 1 < HUFFMAN_STREAMS)
+            put_u32(jumps + 4 * k, payload->pos - start);
+    }
+    if (!payload->error)
+        memcpy(payload->buffer + jump_table, jumps, JUMP_TABLE_SIZE);
+    return reuse ? BLOCK_HUFFMAN4_REUSE : BLOCK_HUFFMAN4;
+}
+
+unsigned char encode_payload(const unsigned char *data, size_t size, const unsigned long long *freq_table,
+                             const unsigned char *lengths, const Code *code_table, Writer *payload) {
+    /**
+     * @brief Записывает сжатые данные блока с готовой таблицей кодов.
+     *
+     * Записывает длины кодов и затем коды всех байтов блока (encode_symbols()),
+     * если choose_block_type() не выбрал запись без кодов Хаффмана.
+     *
+     * @param data Исходные данные блока.
+     * @param size Размер блока (больше 0).
+     * @param freq_table Частоты байтов блока.
+     * @param lengths Длины кодов (у каждого байта блока длина ненулевая).
+     * @param code_table Канонические коды, построенные по lengths.
+     * @param payload Writer, записывающий в память; очищается перед записью.
+     * @return Тип блока.
+     */
+    reset_writer(payload);
+    write_code_lengths(payload, lengths);
+    unsigned char type = choose_block_type(freq_table, size, lengths, 8 * payload->pos + payload->bits_filled);
+    if (type != BLOCK_HUFFMAN)
+        return encode_raw(data, size, type, payload);
+    return encode_symbols(data, size, code_table, 0, payload);
+}
+
+unsigned char encode_block(const unsigned char *data, size_t size, size_t max_length, Writer *payload) {
+    /**
+     * @brief Сжимает блок данных со своей таблицей кодов.
+     *
+     * Строит таблицу частот блока, длины кодов (не длиннее max_length)
+     * и канонические коды, затем записывает блок через encode_payload()
+     * (несжимаемый блок — как BLOCK_STORED, один повторяющийся байт — как BLOCK_RLE).
+     *
+     * @param data Исходные данные блока.
+     * @param size Размер блока (больше 0).
+     * @param max_length Максимальная длина кода.
+     * @param payload Writer, записывающий в память; очищается перед записью.
+     * @return Тип блока.
+     */
+    unsigned long long freq_table[ALPHABET_SIZE] = { 0 };
+    create_freq_table(data, size, freq_table);
+
+    unsigned char lengths[ALPHABET_SIZE];
+    build_code_lengths(freq_table, max_length, lengths);
+
+    Code code_table[ALPHABET_SIZE];
+    generate_canonical_codes(lengths, code_table);
+    return encode_payload(data, size, freq_table, lengths, code_table, payload);
+}
+
+void write_block_header(Writer *output, const BlockHeader *header) {
+    /**
+     * @brief Записывает заголовок блока.
+     *
+     * Заголовок: байт типа, varint исходного размера, varint размера сжатых данных.
+     *
+     * @param output Writer выходного файла (выровненный по байту).
+     * @param header Заголовок блока.
+     */
+    write_byte(output, header->type);
+    write_varint(output, header->original_size);
+    write_varint(output, header->payload_size);
+}
+
+void write_block(Writer *output, const BlockHeader *header, const unsigned char *payload) {
+    /**
+     * @brief Записывает заголовок блока и его сжатые данные.
+     *
+     * @param output Writer выходного файла (выровненный по байту).
+     * @param header Заголовок блока.
+     * @param payload Сжатые данные блока.
+     */
+    write_block_header(output, header);
+    write_bytes(output, payload, header->payload_size);
+}
+
+void write_end_block(Writer *output) {
+    /**
+     * @brief Записывает признак конца архива.
+     *
+     * @param output Writer выходного файла.
+     */
+    write_byte(output, BLOCK_END);
+}
+
+uint32_t block_checksum(const unsigned char *data, size_t size) {
+    /**
+     * @brief Вычисляет контрольную сумму Adler-32 исходных данных блока.
+     *
+     * Суммы накапливаются без взятия остатка отрезками по 5552 байта —
+     * наибольшими, при которых они не переполняют 32 бита.
+     *
+     * @param data Исходные данные блока.
+     * @param size Размер данных.
+     * @return Контрольная сумма.
+     */
+    uint32_t a = 1, b = 0;
+    while (size > 0) {
+        size_t n = (size < 5552) ? size : 5552;
+        size -= n;
+        for (size_t i = 0; i < n; i++) {
+            a += data[i];
+            b += a;
+        }
+        data += n;
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+void write_index(Writer *output, const IndexEntry *entries, const IndexTrailer *trailer) {
+    /**
+     * @brief Записывает индекс блоков и его окончание.
+     *
+     * Запись индекса: смещения заголовка блока в архиве, исходных данных
+     * и заголовка блока с таблицей кодов (по 8 байтов), контрольная сумма (4 байта). Окончание: смещение
+     * индекса и размер исходного файла (по 8 байтов), количество записей
+     * (4 байта) и сигнатура. Все числа — little-endian, поэтому индекс
+     * находится чтением последних INDEX_TRAILER_SIZE байтов архива.
+     *
+     * @param output Writer выходного файла (выровненный по байту).
+     * @param entries Записи индекса.
+     * @param trailer Окончание индекса (index_offset — текущая позиция в архиве).
+     */
+    for (size_t i = 0; i < trailer->count; i++) {
+        unsigned char bytes[INDEX_ENTRY_SIZE];
+        put_u64(bytes, entries[i].block_offset);
+        put_u64(bytes + 8, entries[i].original_offset);
+        put_u64(bytes + 16, entries[i].table_offset);
+        put_u32(bytes + 24, entries[i].checksum);
+        write_bytes(output, bytes, sizeof(bytes));
+    }
+    unsigned char bytes[INDEX_TRAILER_SIZE];
+    put_u64(bytes, trailer->index_offset);
+    put_u64(bytes + 8, trailer->original_size);
+    put_u32(bytes + 16, trailer->count);
+    memcpy(bytes + 20, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    write_bytes(output, bytes, sizeof(bytes));
+}
+
+int read_index_trailer(const unsigned char *bytes, unsigned long long archive_size, IndexTrailer *trailer) {
+    /**
+     * @brief Разбирает и проверяет окончание индекса.
+     *
+     * @param bytes Последние INDEX_TRAILER_SIZE байтов архива.
+     * @param archive_size Размер файла архива.
+     * @param trailer Структура для записи окончания.
+     * @return 1 - если сигнатура верна и индекс занимает ровно конец архива; 0 - иначе.
+     */
+    trailer->index_offset = get_u64(bytes);
+    trailer->original_size = get_u64(bytes + 8);
+    trailer->count = get_u32(bytes + 16);
+    return archive_size >= INDEX_TRAILER_SIZE && memcmp(bytes + 20, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0
+        && trailer->index_offset <= archive_size - INDEX_TRAILER_SIZE
+        && (archive_size - INDEX_TRAILER_SIZE - trailer->index_offset) / INDEX_ENTRY_SIZE == trailer->count
+        && (archive_size - INDEX_TRAILER_SIZE - trailer->index_offset) % INDEX_ENTRY_SIZE == 0;
+}
+
+void read_index_entry(const unsigned char *bytes, IndexEntry *entry) {
+    /**
+     * @brief Разбирает запись индекса.
+     *
+     * @param bytes INDEX_ENTRY_SIZE байтов записи.
+     * @param entry Структура для записи.
+     */
+    entry->block_offset = get_u64(bytes);
+    entry->original_offset = get_u64(bytes + 8);
+    entry->table_offset = get_u64(bytes + 16);
+    entry->checksum = (uint32_t)get_u32(bytes + 24);
+}
+
+int read_block_header(Reader *input, BlockHeader *header) {
+    /**
+     * @brief Считывает и проверяет заголовок блока.
+     *
+     * Отклоняет неизвестные типы и размеры, которые не мог создать архиватор.
+     *
+     * @param input Reader входного файла (выровненный по байту).
+     * @param header Структура для записи заголовка.
+     * @return 1 - если заголовок прочитан и корректен; 0 - иначе.
+     */
+    unsigned long long original_size = 0, payload_size = 0;
+    if (end_of_bits(input))
+        return 0;
+    header->type = read_byte(input);
+    header->original_size = 0;
+    header->payload_size = 0;
+    if (header->type == BLOCK_END)
+        return 1;
+    if (!block_has_table(header->type) && !block_reuses_table(header->type)
+        && header->type != BLOCK_STORED && header->type != BLOCK_RLE)
+        return 0;
+    if (!read_varint(input, &original_size) || !read_varint(input, &payload_size))
+        return 0;
+    if (original_size == 0 || original_size > MAX_BLOCK_SIZE
+        || payload_size > block_payload_bound((size_t)original_size, MAX_CODE_LENGTH))
+        return 0;
+    if ((header->type == BLOCK_HUFFMAN4 || header->type == BLOCK_HUFFMAN4_REUSE) && original_size < STREAMS_MIN_SIZE)
+        return 0;
+    if ((header->type == BLOCK_STORED && payload_size != original_size)
+        || (header->type == BLOCK_RLE && payload_size != 1))
+        return 0;
+    header->original_size = (size_t)original_size;
+    header->payload_size = (size_t)payload_size;
+    return 1;
+}
+
+static int decode_streams_payload(Reader *reader, const BlockHeader *header, const unsigned char *payload,
+                                  const DecodeTable *table, unsigned char *out) {
+    /**
+     * @brief Декодирует потоки блока BLOCK_HUFFMAN4 по таблице переходов.
+     *
+     * @param reader Reader сжатых данных, стоящий сразу после длин кодов.
+     * @param header Заголовок блока.
+     * @param payload Сжатые данные блока.
+     * @param table Таблица декодирования.
+     * @param out Буфер для исходных данных.
+     * @return 1 - при успехе; 0 - если таблица переходов или потоки повреждены.
+     */
+    unsigned char jumps[JUMP_TABLE_SIZE];
+    if (read_bytes(reader, jumps, JUMP_TABLE_SIZE) != JUMP_TABLE_SIZE)
+        return 0;
+    size_t offset = reader->pos - reader->bits_filled / 8;
+
+    Reader readers[HUFFMAN_STREAMS];
+    for (size_t k = 0; k < HUFFMAN_STREAMS; k++) {
+        size_t rest = header->payload_size - offset;
+        size_t size = (k + 1 < HUFFMAN_STREAMS) ? get_u32(jumps + 4 * k) : rest;
+        if (size > rest)
+            return 0;
+        init_memory_reader(&readers[k], payload + offset, size);
+        offset += size;
+    }
+    return decode_streams(readers, table, out, header->original_size);
+}
+
+int read_block_table(const unsigned char *payload, size_t size, DecodeTable *table) {
+    /**
+     * @brief Считывает длины кодов из начала сжатых данных блока и строит таблицу декодирования.
+     *
+     * Нужна, чтобы распаковать блок *_REUSE отдельно от предыдущих:
+     * достаточно первых CODE_LENGTHS_MAX_SIZE байтов блока с таблицей.
+     *
+     * @param payload Сжатые данные блока с длинами кодов.
+     * @param size Доступный размер данных.
+     * @param table Таблица декодирования.
+     * @return 1 - при успехе; 0 - если длины кодов повреждены.
+     */
+    Reader reader;
+    unsigned char lengths[ALPHABET_SIZE];
+    init_memory_reader(&reader, payload, size);
+    return read_code_lengths(&reader, lengths) && build_decode_table(table, lengths);
+}
+
+int decode_block(const BlockHeader *header, const unsigned char *payload, DecodeTable *table, unsigned char *out) {
+    /**
+     * @brief Восстанавливает исходные данные блока.
+     *
+     * Считывает длины кодов, строит по ним таблицу декодирования
+     * и декодирует ровно original_size символов из одного потока
+     * или, для BLOCK_HUFFMAN4, из HUFFMAN_STREAMS потоков. Блоки *_REUSE
+     * декодируются уже построенной таблицей (предыдущего блока или read_block_table()).
+     * Блоки BLOCK_STORED и BLOCK_RLE восстанавливаются копированием
+     * и заполнением, таблица при этом не меняется.
+     *
+     * @param header Заголовок блока.
+     * @param payload Сжатые данные блока.
+     * @param table Таблица декодирования, переиспользуемая между блоками.
+     * @param out Буфер для исходных данных (не меньше original_size байтов).
+     * @return 1 - при успехе; 0 - если данные блока повреждены, не хватило памяти
+     * или блоку *_REUSE не предшествует таблица.
+     */
+    if (header->type == BLOCK_STORED) {
+        memcpy(out, payload, header->original_size);
+        return 1;
+    }
+    if (header->type == BLOCK_RLE) {
+        memset(out, payload[0], header->original_size);
+        return 1;
+    }
+
+    Reader reader;
+    init_memory_reader(&reader, payload, header->payload_size);
+
+    unsigned char lengths[ALPHABET_SIZE];
+    if (block_reuses_table(header->type)) {
+        if (table->max_length == 0)
+            return 0;
+    }
+    else if (!read_code_lengths(&reader, lengths) || !build_decode_table(table, lengths))
+        return 0;
+    if (header->type == BLOCK_HUFFMAN4 || header->type == BLOCK_HUFFMAN4_REUSE)
+        return decode_streams_payload(&reader, header, payload, table, out);
+    return decode_symbols(&reader, table, out, header->original_size) == header->original_size;
+}
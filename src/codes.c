@@ -0,0 +1,344 @@
+#include "codes.h"
+
+size_t max_code_length(const unsigned char *lengths) {
+    /**
+     * @brief Возвращает длину самого длинного кода.
+     *
+     * @param lengths Массив из ALPHABET_SIZE длин кодов.
+     * @return Максимальная длина; 0, если символов нет.
+     */
+    size_t result = 0;
+    for (size_t i = 0; i < ALPHABET_SIZE; i++)
+        if (lengths[i] > result)
+            result = lengths[i];
+    return result;
+}
+
+/**
+ * Символ и его частота (для сортировки по частоте).
+ */
+typedef struct Weight {
+    unsigned long long freq;    ///< Частота символа.
+    unsigned char symbol;       ///< Символ.
+} Weight;
+
+static int compare_weights(const void *a, const void *b) {
+    /**
+     * @brief Сравнивает символы по частоте, при равенстве — по значению.
+     *
+     * @param a Указатель на первый Weight.
+     * @param b Указатель на второй Weight.
+     * @return Отрицательное, ноль или положительное число, как для qsort.
+     */
+    const Weight *x = (const Weight*)a;
+    const Weight *y = (const Weight*)b;
+    if (x->freq != y->freq)
+        return (x->freq < y->freq) ? -1 : 1;
+    return (int)x->symbol - (int)y->symbol;
+}
+
+static size_t sort_weights(const unsigned long long *freq_table, Weight *leaves) {
+    /**
+     * @brief Выбирает встречающиеся символы и сортирует их по возрастанию частоты.
+     *
+     * @param freq_table Массив частот символов.
+     * @param leaves Выходной массив из не более чем ALPHABET_SIZE элементов.
+     * @return Количество встречающихся символов.
+     */
+    size_t n = 0;
+    for (size_t i = 0; i < ALPHABET_SIZE; i++) {
+        if (freq_table[i] != 0) {
+            leaves[n].freq = freq_table[i];
+            leaves[n].symbol = (unsigned char)i;
+            n++;
+        }
+    }
+    qsort(leaves, n, sizeof(Weight), compare_weights);
+    return n;
+}
+
+void generate_code_lengths(const unsigned long long *freq_table, unsigned char *lengths) {
+    /**
+     * @brief Вычисляет длины кодов Хаффмана без построения дерева.
+     *
+     * Символы один раз сортируются по частоте, затем длины вычисляются
+     * «на месте» в массиве весов (алгоритм Моффата–Катаяйнена):
+     * - проход слева направо сливает две очереди — ещё не использованные листья
+     *   и уже созданные внутренние узлы (они возникают в порядке возрастания веса) —
+     *   и заменяет веса поглощённых узлов индексами родителей;
+     * - проход справа налево превращает индексы родителей в глубины внутренних узлов;
+     * - последний проход по глубинам внутренних узлов раздаёт глубины листьям.
+     * Память под узлы не выделяется. Отсутствующие символы получают длину 0,
+     * единственный символ — длину 1. Длины могут превышать MAX_CODE_LENGTH;
+     * при необходимости их ограничивает limit_code_lengths().
+     *
+     * @param freq_table Массив частот символов.
+     * @param lengths Выходной массив из ALPHABET_SIZE длин.
+     */
+    Weight leaves[ALPHABET_SIZE];
+    unsigned long long a[ALPHABET_SIZE];
+    size_t n = sort_weights(freq_table, leaves);
+
+    memset(lengths, 0, ALPHABET_SIZE);
+    if (n == 0)
+        return;
+    if (n == 1) {
+        lengths[leaves[0].symbol] = 1;
+        return;
+    }
+    for (size_t i = 0; i < n; i++)
+        a[i] = leaves[i].freq;
+
+    size_t root = 0, leaf = 2;
+    a[0] += a[1];
+    for (size_t next = 1; next < n - 1; next++) {
+        if (leaf >= n || a[root] < a[leaf]) {
+            a[next] = a[root];
+            a[root++] = next;
+        }
+        else a[next] = a[leaf++];
+
+        if (leaf >= n || (root < next && a[root] < a[leaf])) {
+            a[next] += a[root];
+            a[root++] = next;
+        }
+        else a[next] += a[leaf++];
+    }
+
+    a[n - 2] = 0;
+    for (size_t next = n - 2; next-- > 0; )
+        a[next] = a[a[next]] + 1;
+
+    size_t available = 1, used = 0, depth = 0;
+    size_t internal = n - 1, next = n;
+    while (available > 0) {
+        while (internal > 0 && a[internal - 1] == depth) {
+            used++;
+            internal--;
+        }
+        while (available > used) {
+            lengths[leaves[--next].symbol] = (unsigned char)depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+}
+
+void limit_code_lengths(const unsigned long long *freq_table, size_t max_length, unsigned char *lengths) {
+    /**
+     * @brief Вычисляет оптимальные длины кодов, не превышающие max_length.
+     *
+     * Алгоритм package-merge (Larmore–Hirschberg):
+     * - список глубины max_length состоит из листов, упорядоченных по частоте;
+     * - каждый следующий (менее глубокий) список — слияние листов с «пакетами»
+     *   из пар соседних элементов предыдущего списка;
+     * - из последнего списка берутся первые 2n - 2 элемента; каждый выбранный лист
+     *   удлиняет свой код на 1, а каждый выбранный пакет требует взять
+     *   ещё два элемента из предыдущего списка.
+     * Списки обрезаются до 2n - 2 элементов — остальные никогда не выбираются.
+     * Если max_length < log2(n), ограничение повышается до минимально возможного.
+     *
+     * @param freq_table Массив частот символов.
+     * @param max_length Максимально допустимая длина кода.
+     * @param lengths Выходной массив из ALPHABET_SIZE длин кодов.
+     */
+    Weight leaves[ALPHABET_SIZE];
+    size_t n = sort_weights(freq_table, leaves);
+
+    memset(lengths, 0, ALPHABET_SIZE);
+    if (n == 0)
+        return;
+    if (n == 1) {
+        lengths[leaves[0].symbol] = 1;
+        return;
+    }
+
+    if (max_length > MAX_CODE_LENGTH)
+        max_length = MAX_CODE_LENGTH;
+    while (((size_t)1 << max_length) < n)
+        max_length++;
+
+    size_t limit = 2 * n - 2;
+    unsigned long long weights[2][2 * ALPHABET_SIZE];
+    unsigned char is_package[MAX_CODE_LENGTH][2 * ALPHABET_SIZE];
+    size_t sizes[MAX_CODE_LENGTH];
+
+    for (size_t i = 0; i < n; i++) {
+        weights[0][i] = leaves[i].freq;
+        is_package[0][i] = 0;
+    }
+    sizes[0] = n;
+
+    for (size_t level = 1; level < max_length; level++) {
+        const unsigned long long *prev = weights[(level - 1) & 1];
+        unsigned long long *cur = weights[level & 1];
+        size_t packages = sizes[level - 1] / 2;
+        size_t leaf = 0, package = 0, size = 0;
+        while (size < limit && (leaf < n || package < packages)) {
+            unsigned long long package_weight = (package < packages)
+                ? prev[2 * package] + prev[2 * package + 1] : 0;
+            if (leaf < n && (package == packages || leaves[leaf].freq <= package_weight)) {
+                cur[size] = leaves[leaf++].freq;
+                is_package[level][size++] = 0;
+            }
+            else {
+                cur[size] = package_weight;
+                is_package[level][size++] = 1;
+                package++;
+            }
+        }
+        sizes[level] = size;
+    }
+
+    size_t take = limit;
+    for (size_t level = max_length; level-- > 0; ) {
+        size_t packages = 0, leaf = 0;
+        for (size_t i = 0; i < take && i < sizes[level]; i++) {
+            if (is_package[level][i])
+                packages++;
+            else
+                lengths[leaves[leaf++].symbol]++;
+        }
+        take = 2 * packages;
+    }
+}
+
+void generate_canonical_codes(const unsigned char *lengths, Code *code_table) {
+    /**
+     * @brief Назначает канонические коды Хаффмана.
+     *
+     * Коды одной длины идут подряд в порядке возрастания символов,
+     * а каждая следующая длина продолжает последовательность предыдущей,
+     * поэтому коды однозначно восстанавливаются по одним длинам.
+     *
+     * @param lengths Массив из ALPHABET_SIZE длин кодов.
+     * @param code_table Выходная таблица кодов.
+     */
+    uint32_t count[MAX_CODE_LENGTH + 1] = { 0 };
+    uint32_t next_code[MAX_CODE_LENGTH + 1] = { 0 };
+    for (size_t i = 0; i < ALPHABET_SIZE; i++)
+        count[lengths[i]]++;
+    count[0] = 0;
+
+    uint32_t code = 0;
+    for (size_t len = 1; len <= MAX_CODE_LENGTH; len++) {
+        code = (code + count[len - 1]) << 1;
+        next_code[len] = code;
+    }
+
+    for (size_t i = 0; i < ALPHABET_SIZE; i++) {
+        code_table[i].len = lengths[i];
+        code_table[i].code = (lengths[i] != 0) ? next_code[lengths[i]]++ : 0;
+    }
+}
+
+int check_code_lengths(const unsigned char *lengths) {
+    /**
+     * @brief Проверяет, что длины кодов задают полный префиксный код.
+     *
+     * Сумма 2^(-len) по всем символам должна равняться единице
+     * (неравенство Крафта обращается в равенство). Исключение —
+     * единственный символ с кодом длины 1.
+     *
+     * @param lengths Массив из ALPHABET_SIZE длин кодов.
+     * @return 1 - если длины корректны, 0 - иначе.
+     */
+    unsigned long long kraft = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < ALPHABET_SIZE; i++) {
+        if (lengths[i] > MAX_CODE_LENGTH)
+            return 0;
+        if (lengths[i] != 0) {
+            kraft += 1ULL << (MAX_CODE_LENGTH - lengths[i]);
+            used++;
+        }
+    }
+    if (used == 1)
+        return kraft == (1ULL << (MAX_CODE_LENGTH - 1));
+    return kraft == (1ULL << MAX_CODE_LENGTH);
+}
+
+void write_code_lengths(Writer *writer, const unsigned char *lengths) {
+    /**
+     * @brief Записывает длины кодов всех символов в сжатом виде.
+     *
+     * Длины перечисляются по возрастанию символов последовательностью команд:
+     * - 1 и 5 бит (len - 1): один символ с кодом длины len;
+     * - 01 и 4 бита (run - 1): ещё run символов с той же длиной, что у предыдущего;
+     * - 00 и 8 бит (run - 1): run отсутствующих символов.
+     *
+     * @param writer Указатель на Writer.
+     * @param lengths Массив из ALPHABET_SIZE длин кодов.
+     */
+    size_t i = 0;
+    unsigned char prev = 0;
+    while (i < ALPHABET_SIZE) {
+        size_t run = 1;
+        if (lengths[i] == 0) {
+            while (i + run < ALPHABET_SIZE && lengths[i + run] == 0)
+                run++;
+            write_bits(writer, 0, 2);
+            write_bits(writer, run - 1, 8);
+        }
+        else if (lengths[i] == prev) {
+            while (i + run < ALPHABET_SIZE && run < 16 && lengths[i + run] == prev)
+                run++;
+            write_bits(writer, 1, 2);
+            write_bits(writer, run - 1, 4);
+        }
+        else {
+            write_bits(writer, 1, 1);
+            write_bits(writer, lengths[i] - 1, 5);
+            prev = lengths[i];
+        }
+        i += run;
+    }
+}
+
+int read_code_lengths(Reader *reader, unsigned char *lengths) {
+    /**
+     * @brief Считывает длины кодов, записанные write_code_lengths().
+     *
+     * Каждая команда занимает не больше 10 битов и разбирается по одному
+     * peek_bits() без отдельных вызовов на каждый бит. Каждая команда
+     * заполняет хотя бы одну длину, поэтому разбор занимает не больше
+     * ALPHABET_SIZE шагов при любых входных данных; оборванный поток
+     * и выход серии за алфавит отклоняются.
+     *
+     * @param reader Указатель на Reader.
+     * @param lengths Выходной массив из ALPHABET_SIZE длин кодов.
+     * @return 1 - если длины прочитаны и задают полный префиксный код, 0 - иначе.
+     */
+    size_t i = 0;
+    unsigned char prev = 0;
+    while (i < ALPHABET_SIZE) {
+        unsigned token = (unsigned)peek_bits(reader, 10);
+        size_t bits = 6;
+        size_t run;
+        unsigned char len;
+        if (token & 0x200) {
+            prev = (unsigned char)(((token >> 4) & 0x1F) + 1);
+            run = 1;
+            len = prev;
+        }
+        else if (token & 0x100) {
+            if (prev == 0)
+                return 0;
+            run = ((token >> 4) & 0xF) + 1;
+            len = prev;
+        }
+        else {
+            bits = 10;
+            run = (token & 0xFF) + 1;
+            len = 0;
+        }
+        if (bits > reader->bits_filled || i + run > ALPHABET_SIZE)
+            return 0;
+        consume_bits(reader, bits);
+        for (size_t j = 0; j < run; j++)
+            lengths[i++] = len;
+    }
+    return check_code_lengths(lengths);
+}
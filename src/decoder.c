@@ -0,0 +1,291 @@
+#include "decoder.h"
+
+void init_decode_table(DecodeTable *table) {
+    /**
+     * @brief Инициализирует пустую таблицу декодирования.
+     *
+     * @param table Указатель на таблицу.
+     */
+    table->root_bits = 0;
+    table->max_length = 0;
+}
+
+int build_decode_table(DecodeTable *table, const unsigned char *lengths) {
+    /**
+     * @brief Строит таблицу декодирования по длинам канонических кодов.
+     *
+     * Первичная таблица индексируется первыми root_bits битами потока
+     * и сразу даёт символ и длину кода. Коды длиннее DECODE_TABLE_BITS
+     * дочитываются по дереву с 16-битными индексами узлов.
+     *
+     * Дерево канонического кода строится по уровням без указателей:
+     * на глубине d узлы упорядочены по возрастанию кодов, первые count[d]
+     * из них — листья (символы в порядке возрастания), остальные — внутренние
+     * узлы, потомки которых занимают следующие позиции глубины d + 1.
+     * Узел в позиции p имеет код code(d) + p, где code(d) — первый
+     * канонический код длины d. Память не выделяется, глубина ограничена
+     * MAX_CODE_LENGTH, а количество узлов на уровне и в дереве — ALPHABET_SIZE,
+     * поэтому даже непроверенные длины не приводят к выходу за массивы.
+     *
+     * @param table Указатель на инициализированную таблицу.
+     * @param lengths Массив из ALPHABET_SIZE длин кодов (не длиннее MAX_CODE_LENGTH).
+     * @return 1 - при успехе, 0 - если символов нет или длины не задают префиксный код.
+     */
+    size_t count[MAX_CODE_LENGTH + 1] = { 0 };
+    size_t next[MAX_CODE_LENGTH + 1];
+    unsigned char symbols[ALPHABET_SIZE];
+    for (size_t i = 0; i < ALPHABET_SIZE; i++)
+        count[lengths[i]]++;
+    size_t used = 0;
+    size_t max_len = 0;
+    for (size_t len = 1; len <= MAX_CODE_LENGTH; len++) {
+        next[len] = used;
+        used += count[len];
+        if (count[len] != 0)
+            max_len = len;
+    }
+    for (size_t i = 0; i < ALPHABET_SIZE; i++)
+        if (lengths[i] != 0)
+            symbols[next[lengths[i]]++] = (unsigned char)i;
+    if (used == 0)
+        return 0;
+
+    size_t root = (max_len > DECODE_TABLE_BITS) ? DECODE_TABLE_BITS : max_len;
+    table->root_bits = (unsigned char)root;
+    table->max_length = (unsigned char)max_len;
+    memset(table->entries, 0, ((size_t)1 << root) * sizeof(DecodeEntry));
+
+    uint32_t code = 0;
+    size_t first = 0, internal = 1;
+    size_t parents = 0, nodes = 0;
+    for (size_t depth = 1; depth <= max_len; depth++) {
+        code = (code + (uint32_t)count[depth - 1] * (depth > 1)) << 1;
+        size_t positions = 2 * internal;
+        size_t leaves = count[depth];
+        if (leaves > positions || positions - leaves > ALPHABET_SIZE
+            || (depth >= root && depth < max_len && nodes + positions - leaves > ALPHABET_SIZE))
+            return 0;
+        for (size_t p = 0; p < positions; p++) {
+            int leaf = p < leaves;
+            int inner = !leaf && depth < max_len;
+            unsigned short child = leaf ? (unsigned short)(TREE_LEAF | symbols[first + p])
+                : inner ? (unsigned short)(nodes + p - leaves) : TREE_INVALID;
+            if (depth <= root && leaf) {
+                size_t span = (size_t)1 << (root - depth);
+                for (size_t k = 0; k < span; k++) {
+                    DecodeEntry *entry = &table->entries[((code + p) << (root - depth)) + k];
+                    entry->value = symbols[first + p];
+                    entry->length = (unsigned char)depth;
+                    entry->tree = 0;
+                }
+            }
+            else if (depth == root && inner) {
+                DecodeEntry *entry = &table->entries[code + p];
+                entry->value = child;
+                entry->length = (unsigned char)root;
+                entry->tree = 1;
+            }
+            else if (depth > root) {
+                table->tree[parents + p / 2][p & 1] = child;
+            }
+        }
+        if (depth >= root && depth < max_len) {
+            parents = nodes;
+            nodes += positions - leaves;
+        }
+        first += leaves;
+        internal = positions - leaves;
+    }
+    return 1;
+}
+
+static inline int decode_symbol(Reader *reader, const DecodeTable *table, unsigned char *out) {
+    /**
+     * @brief Декодирует один символ.
+     *
+     * За одно обращение к первичной таблице декодируется целый символ;
+     * длинные коды дочитываются по дереву по одному биту.
+     *
+     * @param reader Структура для чтения битов.
+     * @param table Таблица декодирования.
+     * @param out Указатель для декодированного символа.
+     * @return 1 - при успехе; 0 - если код недопустим или поток оборван.
+     */
+    DecodeEntry entry = table->entries[peek_bits(reader, table->root_bits)];
+    if (entry.length == 0 || entry.length > reader->bits_filled)
+        return 0;
+    consume_bits(reader, entry.length);
+    unsigned short child = entry.value;
+    while (entry.tree && !(child & TREE_LEAF)) {
+        child = table->tree[child][peek_bits(reader, 1)];
+        if (reader->bits_filled == 0)
+            return 0;
+        consume_bits(reader, 1);
+    }
+    if (child == TREE_INVALID)
+        return 0;
+    *out = (unsigned char)child;
+    return 1;
+}
+
+ALWAYS_INLINE unsigned decode_symbol_fast(Reader *reader, const DecodeTable *table, size_t bits) {
+    /**
+     * @brief Декодирует один символ без проверок конца данных.
+     *
+     * В аккумуляторе должно быть не меньше max_length битов.
+     * Недопустимый код (возможен только при единственном символе)
+     * не потребляет битов и возвращается как значение больше 255 без ветвления:
+     * вызывающий цикл объединяет результаты через | и проверяет их в условии.
+     *
+     * @param reader Структура для чтения битов (локальная копия в горячем цикле).
+     * @param table Таблица декодирования.
+     * @param bits Разрядность первичной таблицы (table->root_bits).
+     * @return Декодированный символ или значение больше 255 для недопустимого кода.
+     */
+    DecodeEntry entry = table->entries[(reader->acc >> (reader->bits_filled - bits)) & ((1ULL << bits) - 1)];
+    reader->bits_filled -= entry.length;
+    if (!entry.tree)
+        return entry.value | ((unsigned)(entry.length == 0) << 8);
+
+    unsigned short child = entry.value;
+    do {
+        reader->bits_filled--;
+        child = table->tree[child][(reader->acc >> reader->bits_filled) & 1];
+    } while (!(child & TREE_LEAF));
+    return child & ~TREE_LEAF;
+}
+
+ALWAYS_INLINE int fast_path_ready(const Reader *reader) {
+    /**
+     * @brief Проверяет, можно ли дополнять аккумулятор через refill_bits_fast().
+     *
+     * @param reader Структура для чтения битов.
+     * @return 1 - если Reader читает из памяти и до конца данных не меньше 8 байтов.
+     */
+    return !reader->input && reader->bits_filled > 0 && reader->pos + 8 <= reader->size;
+}
+
+size_t decode_symbols(Reader *reader, const DecodeTable *table, unsigned char *out, size_t count) {
+    /**
+     * @brief Декодирует ровно count символов из потока.
+     *
+     * Основная часть символов декодируется без проверок конца данных:
+     * аккумулятор дополняется одним чтением 8 байтов, после чего в нём
+     * гарантированно хватает битов на 57 / max_length символов. Последние
+     * символы, для которых до конца данных меньше 8 байтов, декодируются
+     * безопасным циклом с проверками. Быстрый цикл работает с локальной
+     * копией Reader: записи в out не могут её изменить, поэтому
+     * аккумулятор и позиция остаются в регистрах.
+     *
+     * @param reader Структура для чтения битов.
+     * @param table Таблица декодирования.
+     * @param out Буфер для декодированных символов (не меньше count байтов).
+     * @param count Количество символов.
+     * @return Количество декодированных символов; меньше count, если поток повреждён или оборван.
+     */
+    size_t i = 0;
+    size_t per_refill = 57 / table->max_length, bits = table->root_bits;
+    unsigned symbols = 0;
+    refill_bits(reader);
+    Reader fast = *reader;
+    while (symbols <= 0xFF && count - i >= per_refill && fast_path_ready(&fast)) {
+        refill_bits_fast(&fast);
+        for (size_t k = 0; k < per_refill; k++) {
+            unsigned symbol = decode_symbol_fast(&fast, table, bits);
+            out[i++] = (unsigned char)symbol;
+            symbols |= symbol;
+        }
+    }
+    *reader = fast;
+    if (symbols > 0xFF)
+        return 0;
+    for (; i < count; i++)
+        if (!decode_symbol(reader, table, &out[i]))
+            return i;
+    return count;
+}
+
+int decode_streams(Reader *readers, const DecodeTable *table, unsigned char *out, size_t count) {
+    /**
+     * @brief Декодирует символы из HUFFMAN_STREAMS независимых потоков.
+     *
+     * Поток k содержит отрезок из segment = ceil(count / HUFFMAN_STREAMS) символов,
+     * начинающийся с k * segment (последние отрезки могут быть короче).
+     * Пока символы есть во всех потоках, за итерацию декодируется по символу
+     * из каждого: позиции в потоках не зависят друг от друга, и процессор
+     * выполняет четыре цепочки декодирования одновременно. Как и в decode_symbols(),
+     * пока во всех потоках остаётся не меньше 8 байтов, декодирование идёт
+     * без проверок конца данных. Быстрый цикл работает с локальными копиями
+     * Reader, которые записи в out не могут изменить, поэтому состояние всех
+     * четырёх потоков остаётся в регистрах, а ошибка проверяется в условии
+     * цикла. Остатки потоков декодируются по одному.
+     *
+     * @param readers Массив из HUFFMAN_STREAMS структур для чтения потоков.
+     * @param table Таблица декодирования.
+     * @param out Буфер для декодированных символов (не меньше count байтов).
+     * @param count Общее количество символов.
+     * @return 1 - при успехе; 0 - если какой-либо поток повреждён или оборван.
+     */
+    size_t segment = (count + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+    size_t sizes[HUFFMAN_STREAMS];
+    for (size_t k = 0; k < HUFFMAN_STREAMS; k++) {
+        size_t start = (k * segment < count) ? k * segment : count;
+        sizes[k] = (count - start < segment) ? count - start : segment;
+    }
+
+    size_t common = sizes[HUFFMAN_STREAMS - 1];
+    unsigned char *out0 = out, *out1 = out + segment, *out2 = out + 2 * segment, *out3 = out + 3 * segment;
+    size_t i = 0;
+    size_t per_refill = 57 / table->max_length, bits = table->root_bits;
+    unsigned symbols = 0;
+    for (size_t k = 0; k < HUFFMAN_STREAMS; k++)
+        refill_bits(&readers[k]);
+    Reader r0 = readers[0], r1 = readers[1], r2 = readers[2], r3 = readers[3];
+    while (symbols <= 0xFF && common - i >= per_refill && fast_path_ready(&r0) && fast_path_ready(&r1)
+           && fast_path_ready(&r2) && fast_path_ready(&r3)) {
+        refill_bits_fast(&r0);
+        refill_bits_fast(&r1);
+        refill_bits_fast(&r2);
+        refill_bits_fast(&r3);
+        for (size_t k = 0; k < per_refill; k++, i++) {
+            unsigned s0 = decode_symbol_fast(&r0, table, bits);
+            unsigned s1 = decode_symbol_fast(&r1, table, bits);
+            unsigned s2 = decode_symbol_fast(&r2, table, bits);
+            unsigned s3 = decode_symbol_fast(&r3, table, bits);
+            out0[i] = (unsigned char)s0;
+            out1[i] = (unsigned char)s1;
+            out2[i] = (unsigned char)s2;
+            out3[i] = (unsigned char)s3;
+            symbols |= s0 | s1 | s2 | s3;
+        }
+    }
+    readers[0] = r0;
+    readers[1] = r1;
+    readers[2] = r2;
+    readers[3] = r3;
+    if (symbols > 0xFF)
+        return 0;
+    for (; i < common; i++) {
+        int ok = decode_symbol(&readers[0], table, &out0[i])
+               & decode_symbol(&readers[1], table, &out1[i])
+               & decode_symbol(&readers[2], table, &out2[i])
+               & decode_symbol(&readers[3], table, &out3[i]);
+        if (!ok)
+            return 0;
+    }
+    for (size_t k = 0; k < HUFFMAN_STREAMS; k++) {
+        size_t rest = sizes[k] - common;
+        if (decode_symbols(&readers[k], table, out + k * segment + common, rest) != rest)
+            return 0;
+    }
+    return 1;
+}
+
+void delete_decode_table(DecodeTable *table) {
+    /**
+     * @brief Освобождает таблицу декодирования (память таблицы встроена в структуру).
+     *
+     * @param table Указатель на таблицу.
+     */
+    init_decode_table(table);
+}
@@ -0,0 +1,118 @@
+#include <string.h>
+#include "histogram.h"
+#include "codes.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HISTOGRAM_AVX2 1
+#endif
+
+/// Банки 32-битных счётчиков: соседние байты попадают в разные банки.
+typedef uint32_t Banks[HISTOGRAM_BANKS][ALPHABET_SIZE];
+
+static void count_scalar(const unsigned char *data, size_t size, Banks banks) {
+    /**
+     * @brief Подсчитывает байты, раскладывая соседние байты по разным банкам.
+     *
+     * При длинных сериях одинаковых байтов единственный счётчик увеличивался бы
+     * подряд, и каждое увеличение ждало бы записи предыдущего. С четырьмя
+     * банками зависимые увеличения разнесены на четыре байта друг от друга.
+     *
+     * @param data Начало области памяти.
+     * @param size Размер области памяти.
+     * @param banks Банки счётчиков.
+     */
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint32_t a, b;
+        memcpy(&a, data + i, 4);
+        memcpy(&b, data + i + 4, 4);
+        banks[0][a & 0xFF]++;
+        banks[1][(a >> 8) & 0xFF]++;
+        banks[2][(a >> 16) & 0xFF]++;
+        banks[3][a >> 24]++;
+        banks[0][b & 0xFF]++;
+        banks[1][(b >> 8) & 0xFF]++;
+        banks[2][(b >> 16) & 0xFF]++;
+        banks[3][b >> 24]++;
+    }
+    for (; i < size; i++)
+        banks[0][data[i]]++;
+}
+
+#ifdef HISTOGRAM_AVX2
+__attribute__((target("avx2")))
+static void count_avx2(const unsigned char *data, size_t size, Banks banks) {
+    /**
+     * @brief Подсчитывает байты, пропуская серии одинаковых байтов целыми векторами.
+     *
+     * Каждые 32 байта сравниваются с первым из них; если совпадают все,
+     * счётчик увеличивается сразу на 32. Остальные векторы считаются
+     * как в count_scalar().
+     *
+     * @param data Начало области памяти.
+     * @param size Размер области памяти.
+     * @param banks Банки счётчиков.
+     */
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i first = _mm256_set1_epi8((char)data[i]);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, first)) == -1)
+            banks[0][data[i]] += 32;
+        else
+            count_scalar(data + i, 32, banks);
+    }
+    count_scalar(data + i, size - i, banks);
+}
+#endif
+
+int histogram_uses_simd(void) {
+    /**
+     * @brief Проверяет, выбрана ли векторная реализация подсчёта.
+     *
+     * Реализация выбирается во время выполнения по возможностям процессора.
+     *
+     * @return 1 - если процессор поддерживает AVX2, 0 - иначе.
+     */
+#ifdef HISTOGRAM_AVX2
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return 0;
+#endif
+}
+
+void create_freq_table(const unsigned char *data, size_t size, unsigned long long *freq_table) {
+    /**
+     * @brief Создает таблицу частот байтов области памяти.
+     *
+     * Байты считаются в HISTOGRAM_BANKS банках 32-битных счётчиков частями
+     * не больше HISTOGRAM_CHUNK, после каждой части банки складываются
+     * в таблицу частот. Таблица заранее должна быть обнулена.
+     *
+     * @param data Начало области памяти.
+     * @param size Размер области памяти.
+     * @param freq_table Массив для хранения частот каждого символа.
+     */
+#ifdef HISTOGRAM_AVX2
+    int simd = histogram_uses_simd();
+#endif
+    Banks banks;
+    while (size > 0) {
+        size_t part = (size < HISTOGRAM_CHUNK) ? size : HISTOGRAM_CHUNK;
+        memset(banks, 0, sizeof(banks));
+#ifdef HISTOGRAM_AVX2
+        if (simd)
+            count_avx2(data, part, banks);
+        else
+            count_scalar(data, part, banks);
+#else
+        count_scalar(data, part, banks);
+#endif
+        for (size_t b = 0; b < HISTOGRAM_BANKS; b++)
+            for (size_t c = 0; c < ALPHABET_SIZE; c++)
+                freq_table[c] += banks[b][c];
+        data += part;
+        size -= part;
+    }
+}
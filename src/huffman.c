@@ -0,0 +1,243 @@
+#include <string.h>
+#include <stdint.h>
+#include "huffman.h"
+#include "block.h"
+
+/**
+ * Контекст библиотеки.
+ */
+struct HuffContext {
+    Writer payload;             ///< Сжатые данные очередного блока.
+    Writer frame;               ///< Заголовок архива или блока перед копированием в выходной буфер.
+    DecodeTable table;          ///< Таблица декодирования, переиспользуемая между блоками и вызовами.
+};
+
+/**
+ * Выходной буфер, заданный пользователем.
+ */
+typedef struct Output {
+    unsigned char *data;        ///< Начало буфера.
+    size_t pos;                 ///< Количество записанных байтов.
+    size_t capacity;            ///< Размер буфера.
+} Output;
+
+HuffContext* huff_create_context(void) {
+    /**
+     * @brief Создаёт контекст сжатия и распаковки.
+     *
+     * Буфер сжатых данных растёт до размера наибольшего блока при первом
+     * сжатии и дальше не перевыделяется.
+     *
+     * @return Указатель на контекст или NULL при ошибке выделения памяти.
+     */
+    HuffContext *context = (HuffContext*)malloc(sizeof(HuffContext));
+    if (!context)
+        return NULL;
+    if (!init_memory_writer(&context->payload, BITIO_BUFFER_SIZE)) {
+        free(context);
+        return NULL;
+    }
+    if (!init_memory_writer(&context->frame, ARCHIVE_HEADER_MAX_SIZE + BLOCK_HEADER_MAX_SIZE)) {
+        delete_writer(&context->payload);
+        free(context);
+        return NULL;
+    }
+    init_decode_table(&context->table);
+    return context;
+}
+
+void huff_delete_context(HuffContext *context) {
+    /**
+     * @brief Освобождает контекст и все его буферы.
+     *
+     * @param context Указатель на контекст (может быть NULL).
+     */
+    if (!context)
+        return;
+    delete_writer(&context->payload);
+    delete_writer(&context->frame);
+    delete_decode_table(&context->table);
+    free(context);
+}
+
+size_t huff_compress_bound(size_t size) {
+    /**
+     * @brief Возвращает наибольший возможный размер архива.
+     *
+     * Данные делятся на блоки DEFAULT_BLOCK_SIZE; сжатые данные блока
+     * не длиннее исходных (иначе блок записывается как BLOCK_STORED),
+     * к ним добавляются заголовки архива и блоков и признак конца.
+     *
+     * @param size Размер исходных данных.
+     * @return Размер выходного буфера, которого всегда хватает huff_compress();
+     *         0 - если граница не помещается в size_t.
+     */
+    size_t blocks = size / DEFAULT_BLOCK_SIZE + (size % DEFAULT_BLOCK_SIZE != 0);
+    size_t overhead = ARCHIVE_HEADER_MAX_SIZE + 1 + blocks * BLOCK_HEADER_MAX_SIZE;
+    if (size > SIZE_MAX - overhead)
+        return 0;
+    return overhead + size;
+}
+
+static int put_bytes(Output *output, const void *data, size_t size) {
+    /**
+     * @brief Дописывает байты в выходной буфер.
+     *
+     * @param output Выходной буфер.
+     * @param data Записываемые байты.
+     * @param size Количество байтов.
+     * @return 1 - при успехе; 0 - если в буфере не хватает места.
+     */
+    if (size > output->capacity - output->pos)
+        return 0;
+    memcpy(output->data + output->pos, data, size);
+    output->pos += size;
+    return 1;
+}
+
+static int put_frame(Output *output, Writer *frame) {
+    /**
+     * @brief Дописывает в выходной буфер заголовок, собранный во frame, и очищает его.
+     *
+     * @param output Выходной буфер.
+     * @param frame Writer с заголовком.
+     * @return 1 - при успехе; 0 - при ошибке памяти или нехватке места.
+     */
+    write_last(frame);
+    int ok = !frame->error && put_bytes(output, frame->buffer, frame->pos);
+    reset_writer(frame);
+    return ok;
+}
+
+int huff_compress_with(HuffContext *context, const void *src, size_t src_size, void *dst, size_t *dst_size) {
+    /**
+     * @brief Сжимает буфер в архив того же формата, что и compress_archive().
+     *
+     * Блоки по DEFAULT_BLOCK_SIZE байтов сжимаются в буфер контекста и сразу
+     * копируются в dst; файлы и процессы не используются.
+     *
+     * @param context Контекст.
+     * @param src Исходные данные.
+     * @param src_size Размер исходных данных.
+     * @param dst Выходной буфер.
+     * @param dst_size На входе — размер dst, на выходе — размер архива.
+     * @return 1 - при успехе; 0 - если не хватило места в dst (huff_compress_bound()),
+     *         граница для src_size не помещается в size_t или не хватило памяти.
+     */
+    if (huff_compress_bound(src_size) == 0)
+        return 0;
+    const unsigned char *data = (const unsigned char*)src;
+    Output output = { (unsigned char*)dst, 0, *dst_size };
+    ArchiveHeader archive = { ARCHIVE_SIZE_KNOWN, src_size };
+    reset_writer(&context->frame);
+    write_archive_header(&context->frame, &archive);
+    int ok = put_frame(&output, &context->frame);
+
+    for (size_t offset = 0; ok && offset < src_size; ) {
+        BlockHeader header;
+        header.original_size = (src_size - offset < DEFAULT_BLOCK_SIZE) ? src_size - offset : DEFAULT_BLOCK_SIZE;
+        header.type = encode_block(data + offset, header.original_size, DEFAULT_CODE_LENGTH, &context->payload);
+        header.payload_size = context->payload.pos;
+        write_block_header(&context->frame, &header);
+        ok = !context->payload.error && put_frame(&output, &context->frame)
+            && put_bytes(&output, context->payload.buffer, header.payload_size);
+        offset += header.original_size;
+    }
+    write_end_block(&context->frame);
+    ok = ok && put_frame(&output, &context->frame);
+    if (ok)
+        *dst_size = output.pos;
+    return ok;
+}
+
+int huff_decompress_with(HuffContext *context, const void *src, size_t src_size, void *dst, size_t *dst_size) {
+    /**
+     * @brief Распаковывает архив из буфера.
+     *
+     * Блоки декодируются прямо в dst, без промежуточных буферов. Таблица
+     * контекста сбрасывается, чтобы блок *_REUSE не декодировался
+     * по таблице предыдущего архива.
+     *
+     * @param context Контекст.
+     * @param src Архив.
+     * @param src_size Размер архива.
+     * @param dst Выходной буфер.
+     * @param dst_size На входе — размер dst, на выходе — размер исходных данных.
+     * @return 1 - при успехе; 0 - если архив повреждён или не помещается в dst.
+     */
+    const unsigned char *data = (const unsigned char*)src;
+    unsigned char *out = (unsigned char*)dst;
+    size_t offset = 0, total = 0;
+    Reader reader;
+    ArchiveHeader archive;
+    BlockHeader header;
+    init_decode_table(&context->table);
+    init_memory_reader(&reader, data, src_size);
+    int ok = read_archive_header(&reader, &archive);
+    while (ok && (ok = read_block_header(&reader, &header)) && header.type != BLOCK_END) {
+        offset += reader.pos - reader.bits_filled / 8;
+        ok = header.payload_size <= src_size - offset && header.original_size <= *dst_size - total
+            && decode_block(&header, data + offset, &context->table, out + total);
+        if (!ok)
+            break;
+        offset += header.payload_size;
+        total += header.original_size;
+        init_memory_reader(&reader, data + offset, src_size - offset);
+    }
+    ok = ok && (!(archive.flags & ARCHIVE_SIZE_KNOWN) || total == archive.original_size);
+    if (ok)
+        *dst_size = total;
+    return ok;
+}
+
+int huff_compress(const void *src, size_t src_size, void *dst, size_t *dst_size) {
+    /**
+     * @brief Сжимает буфер в архив с временным контекстом.
+     *
+     * @param src Исходные данные.
+     * @param src_size Размер исходных данных.
+     * @param dst Выходной буфер.
+     * @param dst_size На входе — размер dst, на выходе — размер архива.
+     * @return 1 - при успехе; 0 - если не хватило места в dst или памяти.
+     */
+    HuffContext *context = huff_create_context();
+    int ok = context && huff_compress_with(context, src, src_size, dst, dst_size);
+    huff_delete_context(context);
+    return ok;
+}
+
+int huff_decompress(const void *src, size_t src_size, void *dst, size_t *dst_size) {
+    /**
+     * @brief Распаковывает архив из буфера с временным контекстом.
+     *
+     * @param src Архив.
+     * @param src_size Размер архива.
+     * @param dst Выходной буфер.
+     * @param dst_size На входе — размер dst, на выходе — размер исходных данных.
+     * @return 1 - при успехе; 0 - если архив повреждён, не помещается в dst или не хватило памяти.
+     */
+    HuffContext *context = huff_create_context();
+    int ok = context && huff_decompress_with(context, src, src_size, dst, dst_size);
+    huff_delete_context(context);
+    return ok;
+}
+
+int huff_decompressed_size(const void *src, size_t src_size, unsigned long long *size) {
+    /**
+     * @brief Возвращает размер исходных данных, записанный в заголовке архива.
+     *
+     * Позволяет выделить выходной буфер для huff_decompress() заранее.
+     *
+     * @param src Архив.
+     * @param src_size Размер архива.
+     * @param size Указатель для размера.
+     * @return 1 - при успехе; 0 - если заголовок повреждён или размер в нём не записан.
+     */
+    Reader reader;
+    ArchiveHeader archive;
+    init_memory_reader(&reader, (const unsigned char*)src, src_size);
+    if (!read_archive_header(&reader, &archive) || !(archive.flags & ARCHIVE_SIZE_KNOWN))
+        return 0;
+    *size = archive.original_size;
+    return 1;
+}
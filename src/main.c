@@ -1,288 +1,238 @@
 #include <stdlib.h>
 #include <stdio.h>
-#include "queue.h"
-#include "tree.h"
-#include "bitset.h"
-#include "bitio.h"
-
-enum {BUFFER_SIZE = 4096};
-enum {ALPHABET_SIZE = 256};
-
-size_t get_lbo(const unsigned long long *freq_table, Bitset *code_table) {
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include "archive.h"
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+int archiver(FILE* input, FILE* output, char mode, const Options *options,
+              unsigned long long offset, unsigned long long length) {
     /**
-     * @brief Вычисляет кол-во значащих битов в последнем байте закодированного файла.
+     * @brief Универсальная функция: сжатие или распаковка в зависимости от режима.
      * 
-     * Для каждого символа вычисляется частота и длина его кода, 
-     * их произведение мод 8, затем суммируется.
+     * - В режиме 'c': сжимает файл поблочно, у каждого блока своя таблица кодов.
+     * - В режиме 'd': распаковывает архив блок за блоком.
+     * - В режиме 'x': распаковывает только заданный диапазон исходного файла.
+     * Об ошибках сообщает в stderr.
      * 
-     * @param freq_table Массив частот для каждого символа.
-     * @param code_table Таблица битовых представлений для каждого символа.
-     * @return Кол-во значащих битов в последнем байте закодированного файла.
+     * @param input Входной файл для обработки.
+     * @param output Выходной файл для записи результата.
+     * @param mode Режим работы: 'c' для сжатия, 'd' для восстановления, 'x' для извлечения диапазона.
+     * @param options Параметры сжатия и распаковки.
+     * @param offset Начало диапазона (режим 'x').
+     * @param length Длина диапазона (режим 'x').
+     * @return 1 - при успехе; 0 - при ошибке.
      */
-    size_t result = 0;
-    for (size_t i = 0; i < ALPHABET_SIZE; i++) {
-        result += ((freq_table[i] % 8) * (code_table[i].size % 8)) % 8;
+    if (mode == 'c' && !compress_archive(input, output, options)) {
+        fputs("Compression Error\n", stderr);
+        return 0;
     }
-    return (result % 8);
-}
 
-void encode_node(Writer *writer, Node *node) {
-    /**
-     * @brief Рекурсивно кодирует дерево Хаффмана в битовый поток.
-     * 
-     * Прямой обход дерева. Лист — бит 1 и значение, 
-     * внутренний узел — бит 0 и рекурсивный вызов для потомков.
-     * 
-     * @param writer Структура для записи битов в выходной поток.
-     * @param node Корень дерева, которое нужно закодировать.
-     */
-    if (is_leaf(node)) {
-        write_bit(writer, 1);
-        write_byte(writer, node->value);
-    }
-    else {
-        write_bit(writer, 0);
-        encode_node(writer, node->left);
-        encode_node(writer, node->right);
+    if (mode == 'd' && !decompress_archive(input, output, options)) {
+        fputs("Corrupted Archive\n", stderr);
+        return 0;
     }
-}
 
-Node* read_node(Reader *reader) {
-    /**
-     * @brief Рекурсивно восстанавливает дерево Хаффмана из битового потока.
-     * 
-     * Читает бит, если 1 — создаёт лист, 
-     * если 0 — рекурсивно читает левое и правое поддеревья.
-     * 
-     * @param reader Структура для чтения битов из входного потока.
-     * @return Указатель на считанный узел дерева.
-     */
-    if (read_bit(reader) == 1)
-        return new_node(read_byte(reader), NULL, NULL);
-    else {
-        Node* left = read_node(reader);
-        Node* right = read_node(reader);
-        return new_node(0, left, right);
+    if (mode == 'x' && !extract_archive(input, output, offset, length, options)) {
+        fputs("Cannot Extract Range\n", stderr);
+        return 0;
     }
+    return 1;
 }
 
-void create_freq_table(FILE* input, unsigned long long *freq_table) {
+void print_usage(void) {
     /**
-     * @brief Создает таблицу частот символов из входного файла.
-     * 
-     * Считывает буферами файл и увеличивает счётчик каждого байта.
-     * 
-     * @param input Входной файл, из которого извлекаются символы.
-     * @param freq_table Массив для хранения частот каждого символа.
+     * @brief Выводит в stderr краткую справку по аргументам командной строки.
      */
-    unsigned char buffer[BUFFER_SIZE] = "";
-    size_t read = fread(buffer, sizeof(char), BUFFER_SIZE, input);
-    while(read != 0) {
-        for (size_t i = 0; i < read; i++)
-            freq_table[buffer[i]]++;
-        read = fread(buffer, sizeof(char), BUFFER_SIZE, input);
-    }
+    fputs("Usage: huffman_archiver c|d|x [options] input output   (\"-\" for stdin/stdout)\n"
+          "  -l N   maximum code length, 1..32 (default 15)\n"
+          "  -b N   block size in bytes, K/M suffixes allowed, 4K..64M (default 1M)\n"
+          "  -j N   number of worker threads for c and d, 1..256 (default 1)\n"
+          "  --stats[=json]   print per-phase timings and sizes to stderr\n"
+          "  --index  append a block index for fast x (c only)\n"
+          "  --no-reuse  always store a code table in every block (c only)\n"
+          "  -s N   x: first byte of the range to extract (default 0)\n"
+          "  -n N   x: number of bytes to extract (default: to the end)\n", stderr);
 }
 
-Node* generate_tree(unsigned long long *freq_table) {
+int parse_number(const char *text, unsigned long long min, unsigned long long max,
+                 unsigned long long *value) {
     /**
-     * @brief Генерирует дерево Хаффмана на основе таблицы частот.
+     * @brief Разбирает десятичное число из аргумента командной строки.
      * 
-     * Постепенно объединяет наименее частотные узлы в дерево, пока не останется один.
+     * Допускаются суффиксы K, M и G (умножение на 2^10, 2^20 и 2^30).
+     * Знак, пробелы и переполнение (в том числе после суффикса) считаются ошибкой.
      * 
-     * @param freq_table Массив частот символов.
-     * @return Указатель на корень дерева Хаффмана.
+     * @param text Строка с числом.
+     * @param min Минимальное допустимое значение.
+     * @param max Максимальное допустимое значение.
+     * @param value Указатель для записи результата.
+     * @return 1 - если число корректно и лежит в [min, max]; 0 - иначе.
      */
-    Queue queue;
-    init_queue(&queue);
-    for (size_t i = 0; i < ALPHABET_SIZE; i++) {
-        if (freq_table[i] != 0) {
-            Node* node = (Node*)malloc(sizeof(Node));
-            node->value = i;
-            node->left = NULL;
-            node->right = NULL;
-            enqueue(&queue, node, freq_table[i]);
-        }
+    if (*text < '0' || *text > '9')
+        return 0;
+    char *end = NULL;
+    errno = 0;
+    unsigned long long number = strtoull(text, &end, 10);
+    if (errno == ERANGE)
+        return 0;
+    int shift = 0;
+    if (*end == 'K' || *end == 'k')
+        shift = 10;
+    else if (*end == 'M' || *end == 'm')
+        shift = 20;
+    else if (*end == 'G' || *end == 'g')
+        shift = 30;
+    if (shift) {
+        if (number > (ULLONG_MAX >> shift))
+            return 0;
+        number <<= shift;
+        end++;
     }
-
-    if (!is_empty(queue)) {
-        while (queue.length > 1) {
-            unsigned long long priority = 0;
-
-            priority += get_priority(queue);
-            Node* left_node = get_node(queue);
-            dequeue(&queue);
-
-            priority += get_priority(queue);
-            Node* right_node = get_node(queue);
-            dequeue(&queue);
-
-            Node* node = new_node(0, left_node, right_node);
-            if (node)
-                enqueue(&queue, node, priority);
-            else {
-                fputs("Stack Overflow", stderr);
-                delete_queue(&queue);
-                free(left_node);
-                free(right_node);
-                return NULL;
-            }
-        }
-        Node* root = get_node(queue);
-        dequeue(&queue);
-        return root;
-    }
-    else return NULL;
+    if (*end != '\0' || number < min || number > max)
+        return 0;
+    *value = number;
+    return 1;
 }
 
-void generate_bitsets(Node* node, Bitset bs, Bitset* code_table) {
+int parse_size(const char *text, size_t min, size_t max, size_t *value) {
     /**
-     * @brief Генерирует таблицу битовых кодов Хаффмана для каждого символа.
-     * 
-     * рекурсивный обход дерева. Левое поддерево — бит 0, правое — бит 1. 
-     * Коды копируются в таблицу.
+     * @brief Разбирает число, как parse_number(), в переменную типа size_t.
      * 
-     * @param node Узел дерева Хаффмана.
-     * @param bs Промежуточный  битсет.
-     * @param code_table Выходная таблица кодов.
+     * @param text Строка с числом.
+     * @param min Минимальное допустимое значение.
+     * @param max Максимальное допустимое значение.
+     * @param value Указатель для записи результата.
+     * @return 1 - если число корректно и лежит в [min, max]; 0 - иначе.
      */
-    if (node) {
-        if (is_leaf(node)) {
-            if (bs.size == 0)
-                append_bit(&bs, 1);
-            copy_bitset(&code_table[node->value], bs);
-        }
-        else {
-            append_bit(&bs, 1);
-            generate_bitsets(node->right, bs, code_table);
-            rewrite_at(&bs, bs.size - 1, 0);
-            generate_bitsets(node->left, bs, code_table);
-        }
-    }
+    unsigned long long number;
+    if (!parse_number(text, min, max, &number))
+        return 0;
+    *value = (size_t)number;
+    return 1;
 }
 
-void compress(FILE *input, Writer *writer, Bitset* code_table) {
+FILE* open_file(const char *path, const char *mode, FILE *standard) {
     /**
-     * @brief Сжимает данные, используя коды Хаффмана.
+     * @brief Открывает файл; путь "-" означает стандартный поток.
      * 
-     * По каждому байту входного файла выбирается соответствующий 
-     * битовый код и записывается в поток.
+     * Стандартный поток переводится в двоичный режим (важно для Windows).
      * 
-     * @param input Входной файл для сжатия.
-     * @param writer Писатель битов.
-     * @param code_table Таблица кодов.
+     * @param path Путь к файлу или "-".
+     * @param mode Режим открытия для fopen.
+     * @param standard Стандартный поток, подставляемый вместо "-" (stdin или stdout).
+     * @return Указатель на открытый файл или NULL при ошибке.
      */
-    unsigned char buffer[BUFFER_SIZE] = "";
-
-    size_t read = fread(buffer, sizeof(char), BUFFER_SIZE, input);
-    while (read != 0) {
-        for (size_t i = 0; i < read; i++)
-            print_bitset(code_table[buffer[i]], writer);
-
-        read = fread(buffer, sizeof(char), BUFFER_SIZE, input);
-    }
+    if (strcmp(path, "-") != 0)
+        return fopen(path, mode);
+#ifdef _WIN32
+    _setmode(_fileno(standard), _O_BINARY);
+#endif
+    return standard;
 }
 
-void decompress(Reader *reader, FILE* output, Node *h_tree, size_t lbo) {
+int close_file(FILE *file) {
     /**
-     * @brief Распаковывает данные, используя дерево Хаффмана.
+     * @brief Закрывает файл, открытый open_file(); стандартные потоки лишь сбрасываются.
      * 
-     * @param reader Структура для чтения битов.
-     * @param output Файл для записи декодированных данных.
-     * @param h_tree Корень дерева Хаффмана.
-     * @param lbo Смещение битов для окончания чтения.
+     * @param file Указатель на файл (может быть NULL).
+     * @return 1 - если буферизованные данные записаны; 0 - при ошибке записи.
      */
-    Node *node = h_tree;
-    while (!feof(reader->input) || reader->bits_filled != (8 - lbo)) {
-        unsigned char bit = read_bit(reader);
-        if (!is_leaf(h_tree)) {
-            if (bit == 1)
-                node = node->right;
-            else
-                node = node->left;
-        }
-        if (is_leaf(node)) {
-            fputc(node->value, output);
-            node = h_tree;
-        }
-    }
+    if (file == stdin || file == stdout)
+        return fflush(file) == 0;
+    if (file)
+        return fclose(file) == 0;
+    return 1;
 }
 
-void archiver(FILE* input, FILE* output, char mode) {
-    /**
-     * @brief Универсальная функция: сжатие или распаковка в зависимости от режима.
-     * 
-     * - В режиме 'c': строит таблицу частот, дерево, кодирует его, пишет LBO и сжимает файл.
-     * - В режиме 'd': восстанавливает дерево, считывает LBO и распаковывает данные.
-     * 
-     * @param input Входной файл для обработки.
-     * @param output Выходной файл для записи результата.
-     * @param mode Режим работы: 'c' для сжатия и 'd' для восстановления.
-     */
-    if (mode == 'c') {
-        long pos = ftell(input);
-        unsigned long long freq_table[ALPHABET_SIZE] = { 0 };
-        create_freq_table(input, freq_table);
-        fseek(input, pos, SEEK_SET);
-
-        Node* root = generate_tree(freq_table);
-        if (root) {
-            Bitset code_table[ALPHABET_SIZE];
-            for (size_t i = 0; i < ALPHABET_SIZE; i++)
-                init_bitset(&code_table[i]);
-
-            Bitset bs;
-            init_bitset(&bs);
-            generate_bitsets(root, bs, code_table);
-
-            Writer writer;
-            init_writer(&writer, output);
-
-            encode_node(&writer, root);
-            size_t lbo = (writer.bits_filled + 3 + get_lbo(freq_table, code_table)) % 8;
-            write_number(&writer, lbo, 3);
-            compress(input, &writer, code_table);
-            write_last(&writer);
-
-            delete_tree(root);
-        }
-    }
-
-    if (mode == 'd') {
-        Reader reader;
-        init_reader(&reader, input);
-        if (!feof(reader.input)) {
-            Node* root = read_node(&reader);
-            size_t lbo = read_number(&reader, 3);
-            lbo = (lbo == 0) ? 8 : lbo;
-
-            decompress(&reader, output, root, lbo);
-            delete_tree(root);
-        }
-    }
-}
-
-void console_handler(int argc, char** argv) {
+int console_handler(int argc, char** argv) {
     /**
      * @brief Обрабатывает аргументы командной строки и вызывает архивацию/распаковку.
      * 
+     * Формат: <c|d|x> [-l N] [-b N] [-j N] [--stats[=json]] [--index] [--no-reuse] [-s N] [-n N] <input> <output>.
+     * Вместо любого из файлов можно указать "-" (stdin/stdout): сжатие читает вход
+     * один раз по блокам, поэтому работает в конвейерах с ограниченной памятью.
      * Проверяет корректность аргументов, открывает файлы и вызывает archiver().
+     * Режим x извлекает -n байтов с позиции -s; архив должен быть обычным файлом.
+     * Параметры, относящиеся к другому режиму (-s и -n вне x, -j в x,
+     * --index и --no-reuse вне c), считаются ошибкой.
+     * С --stats после работы печатает в stderr время фаз и размеры (--stats=json — одной строкой JSON).
      * 
      * @param argc Количество аргументов командной строки.
      * @param argv Массив строк с аргументами командной строки.
+     * @return 1 - при успехе; 0 - при неверных аргументах или ошибке обработки.
      */
-    if (argc == 4) {
-        if (strcmp(argv[1], "c") == 0 || strcmp(argv[1], "d") == 0) {
-            char mode = argv[1][0];
-            FILE* input = fopen(argv[2], "rb");
-            FILE* output = fopen(argv[3], "wb");
-            if (input && output) {
-                archiver(input, output, mode);
-            }
-            fclose(input);
-            fclose(output);
+    Options options;
+    init_options(&options);
+    Stats stats;
+    init_stats(&stats);
+    int json = 0;
+    unsigned long long offset = 0, length = ULLONG_MAX;
+
+    if (argc < 4 || (strcmp(argv[1], "c") != 0 && strcmp(argv[1], "d") != 0 && strcmp(argv[1], "x") != 0)) {
+        print_usage();
+        return 0;
+    }
+    char mode = argv[1][0];
+    for (int i = 2; i < argc - 2; i++) {
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc - 2
+            && parse_size(argv[i + 1], 1, MAX_CODE_LENGTH, &options.max_code_length)) {
+            i++;
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc - 2
+            && parse_size(argv[i + 1], MIN_BLOCK_SIZE, MAX_BLOCK_SIZE, &options.block_size)) {
+            i++;
+        }
+        else if (strcmp(argv[i], "-j") == 0 && mode != 'x' && i + 1 < argc - 2
+            && parse_size(argv[i + 1], 1, MAX_THREADS, &options.threads)) {
+            i++;
+        }
+        else if (strcmp(argv[i], "-s") == 0 && mode == 'x' && i + 1 < argc - 2
+            && parse_number(argv[i + 1], 0, ULLONG_MAX, &offset)) {
+            i++;
+        }
+        else if (strcmp(argv[i], "-n") == 0 && mode == 'x' && i + 1 < argc - 2
+            && parse_number(argv[i + 1], 0, ULLONG_MAX, &length)) {
+            i++;
+        }
+        else if (strcmp(argv[i], "--index") == 0 && mode == 'c') {
+            options.index = 1;
         }
+        else if (strcmp(argv[i], "--no-reuse") == 0 && mode == 'c') {
+            options.reuse_tables = 0;
+        }
+        else if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=json") == 0) {
+            options.stats = &stats;
+            json = argv[i][7] == '=';
+        }
+        else {
+            print_usage();
+            return 0;
+        }
+    }
+
+    double start = stats_clock();
+    FILE* input = open_file(argv[argc - 2], "rb", stdin);
+    FILE* output = open_file(argv[argc - 1], "wb", stdout);
+    int ok = input && output;
+    if (ok) {
+        ok = archiver(input, output, mode, &options, offset, length);
+    }
+    else fputs("Cannot Open File\n", stderr);
+    close_file(input);
+    if (!close_file(output) && ok) {
+        fputs("Cannot Write File\n", stderr);
+        ok = 0;
+    }
+    if (options.stats && input && output) {
+        stats.wall = stats_clock() - start;
+        print_stats(&stats, mode, json, stderr);
     }
+    return ok;
 }
 
 int main(int argc, char** argv) {
@@ -293,8 +243,7 @@ int main(int argc, char** argv) {
      * 
      * @param argc Количество аргументов командной строки.
      * @param argv Массив строк с аргументами командной строки.
-     * @return EXIT_SUCCESS при завершении.
+     * @return EXIT_SUCCESS при успехе; EXIT_FAILURE при ошибке.
      */
-    console_handler(argc, argv);
-    return EXIT_SUCCESS;
+    return console_handler(argc, argv) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
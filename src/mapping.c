@@ -0,0 +1,63 @@
+#include "mapping.h"
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+int map_input(Mapping *mapping, FILE *file) {
+    /**
+     * @brief Отображает в память остаток обычного файла, начиная с текущей позиции.
+     *
+     * Данные читаются прямо из страничного кэша без копирования в буферы;
+     * ядру сообщается, что файл будет читаться последовательно.
+     * Каналы, пустые файлы и файлы, не помещающиеся в адресное пространство,
+     * не отображаются — для них используется обычный буферизованный ввод.
+     * Файл не должен изменяться, пока он отображён.
+     *
+     * @param mapping Указатель на Mapping.
+     * @param file Входной файл.
+     * @return 1 - если файл отображён; 0 - если нужно читать его через fread.
+     */
+    mapping->data = NULL;
+    mapping->size = 0;
+    mapping->base = NULL;
+    mapping->length = 0;
+#ifndef _WIN32
+    struct stat info;
+    off_t pos = ftello(file);
+    if (pos < 0 || fstat(fileno(file), &info) != 0 || !S_ISREG(info.st_mode))
+        return 0;
+    if (info.st_size <= pos || (unsigned long long)info.st_size > (size_t)-1)
+        return 0;
+
+    void *base = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if (base == MAP_FAILED)
+        return 0;
+    madvise(base, (size_t)info.st_size, MADV_SEQUENTIAL);
+    mapping->base = base;
+    mapping->length = (size_t)info.st_size;
+    mapping->data = (const unsigned char*)base + pos;
+    mapping->size = (size_t)(info.st_size - pos);
+    return 1;
+#else
+    (void)file;
+    return 0;
+#endif
+}
+
+void unmap_input(Mapping *mapping) {
+    /**
+     * @brief Снимает отображение файла (если оно было создано).
+     *
+     * @param mapping Указатель на Mapping.
+     */
+#ifndef _WIN32
+    if (mapping->base)
+        munmap(mapping->base, mapping->length);
+#endif
+    mapping->data = NULL;
+    mapping->size = 0;
+    mapping->base = NULL;
+    mapping->length = 0;
+}
@@ -0,0 +1,147 @@
+#include "pool.h"
+
+static void *worker(void *arg) {
+    /**
+     * @brief Основной цикл рабочего потока.
+     *
+     * Забирает задачи из очереди и выполняет их, пока пул не остановлен
+     * и очередь не опустела.
+     *
+     * @param arg Указатель на пул.
+     * @return NULL.
+     */
+    Pool *pool = (Pool*)arg;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->length == 0 && !pool->stop)
+            pthread_cond_wait(&pool->available, &pool->lock);
+        if (pool->length == 0)
+            break;
+        Task task = pool->tasks[pool->first];
+        pool->first = (pool->first + 1) % pool->capacity;
+        pool->length--;
+        pthread_mutex_unlock(&pool->lock);
+
+        task.function(task.arg);
+
+        pthread_mutex_lock(&pool->lock);
+        *task.done = 1;
+        pthread_cond_broadcast(&pool->finished);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+int init_pool(Pool *pool, size_t threads, size_t capacity) {
+    /**
+     * @brief Создаёт пул рабочих потоков.
+     *
+     * При threads <= 1 потоки не создаются, и submit_task() выполняет
+     * задачу сразу в вызывающем потоке.
+     *
+     * @param pool Указатель на пул.
+     * @param threads Количество рабочих потоков.
+     * @param capacity Наибольшее количество одновременно ожидающих задач.
+     * @return 1 - при успехе; 0 - при ошибке выделения памяти или создания потоков.
+     */
+    pool->threads = NULL;
+    pool->tasks = NULL;
+    pool->count = 0;
+    pool->capacity = capacity;
+    pool->first = 0;
+    pool->length = 0;
+    pool->stop = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->available, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+    if (threads <= 1)
+        return 1;
+
+    pool->tasks = (Task*)malloc(capacity * sizeof(Task));
+    pool->threads = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    if (!pool->tasks || !pool->threads)
+        return 0;
+    for (; pool->count < threads; pool->count++)
+        if (pthread_create(&pool->threads[pool->count], NULL, worker, pool) != 0)
+            return 0;
+    return 1;
+}
+
+void submit_task(Pool *pool, TaskFunction function, void *arg, int *done) {
+    /**
+     * @brief Ставит задачу в очередь пула.
+     *
+     * Вызывающий обязан не превышать capacity одновременно незавершённых задач.
+     *
+     * @param pool Указатель на пул.
+     * @param function Выполняемая функция.
+     * @param arg Аргумент функции.
+     * @param done Флаг завершения; обнуляется здесь и выставляется в 1 после выполнения.
+     */
+    *done = 0;
+    if (pool->count == 0) {
+        function(arg);
+        *done = 1;
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    Task task = { function, arg, done };
+    pool->tasks[(pool->first + pool->length) % pool->capacity] = task;
+    pool->length++;
+    pthread_cond_signal(&pool->available);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void signal_flag(Pool *pool, int *flag) {
+    /**
+     * @brief Выставляет флаг и будит ожидающих его в wait_task().
+     *
+     * Позволяет задаче сообщить о готовности промежуточного результата,
+     * которого ждёт следующая задача, не дожидаясь своего завершения.
+     *
+     * @param pool Указатель на пул.
+     * @param flag Флаг, ожидаемый через wait_task().
+     */
+    pthread_mutex_lock(&pool->lock);
+    *flag = 1;
+    pthread_cond_broadcast(&pool->finished);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void wait_task(Pool *pool, int *done) {
+    /**
+     * @brief Ожидает завершения задачи.
+     *
+     * @param pool Указатель на пул.
+     * @param done Флаг завершения задачи, переданный в submit_task().
+     */
+    pthread_mutex_lock(&pool->lock);
+    while (!*done)
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void delete_pool(Pool *pool) {
+    /**
+     * @brief Останавливает рабочие потоки и освобождает ресурсы пула.
+     *
+     * Уже поставленные в очередь задачи выполняются до остановки.
+     *
+     * @param pool Указатель на пул.
+     */
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->available);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->count; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    free(pool->threads);
+    free(pool->tasks);
+    pool->threads = NULL;
+    pool->tasks = NULL;
+    pool->count = 0;
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->available);
+    pthread_cond_destroy(&pool->finished);
+}
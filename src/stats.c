@@ -0,0 +1,178 @@
+#include <math.h>
+#include <time.h>
+#include "stats.h"
+
+/// Названия фаз в отчёте.
+static const char *PHASE_NAMES[STATS_PHASES] = {
+    "histogram", "code_lengths", "code_generation", "encode", "write", "table_wait", "decode"
+};
+
+/// Названия типов блоков в отчёте.
+static const char *BLOCK_TYPE_NAMES[BLOCK_TYPES] = {
+    "end", "huffman", "huffman4", "huffman_reuse", "huffman4_reuse", "stored", "rle"
+};
+
+void init_stats(Stats *stats) {
+    /**
+     * @brief Обнуляет статистику.
+     *
+     * @param stats Указатель на статистику.
+     */
+    memset(stats, 0, sizeof(*stats));
+}
+
+double stats_clock(void) {
+    /**
+     * @brief Возвращает монотонное время в секундах.
+     *
+     * @return Время в секундах от произвольной точки отсчёта.
+     */
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static double entropy(const unsigned long long *freq_table, unsigned long long *total) {
+    /**
+     * @brief Вычисляет энтропию распределения байтов.
+     *
+     * @param freq_table Массив частот символов.
+     * @param total Указатель для количества символов.
+     * @return Энтропия в битах на символ (0, если символов нет).
+     */
+    *total = 0;
+    for (size_t i = 0; i < ALPHABET_SIZE; i++)
+        *total += freq_table[i];
+    double result = 0;
+    for (size_t i = 0; i < ALPHABET_SIZE; i++) {
+        if (freq_table[i] != 0) {
+            double p = (double)freq_table[i] / (double)*total;
+            result -= p * log2(p);
+        }
+    }
+    return result;
+}
+
+void add_block_stats(Stats *stats, unsigned char type, const unsigned long long *freq_table,
+                     const unsigned char *lengths) {
+    /**
+     * @brief Учитывает частоты и длины кодов очередного блока.
+     *
+     * Энтропия блока умножается на его размер и прибавляется к границе Шеннона:
+     * у каждого блока своя таблица, поэтому средняя длина кода сравнивается
+     * с энтропией блоков, а не всего файла. Блок BLOCK_STORED занимает
+     * 8 битов на байт, BLOCK_RLE — 0; длины кодов для них не используются.
+     *
+     * @param stats Указатель на статистику.
+     * @param type Способ записи блока (choose_block_type()).
+     * @param freq_table Частоты байтов блока.
+     * @param lengths Длины кодов блока.
+     */
+    unsigned long long total;
+    stats->entropy_bits += entropy(freq_table, &total) * (double)total;
+    for (size_t i = 0; i < ALPHABET_SIZE; i++)
+        stats->freq_table[i] += freq_table[i];
+    if (type == BLOCK_STORED)
+        stats->code_bits += 8.0 * (double)total;
+    else if (type != BLOCK_RLE)
+        for (size_t i = 0; i < ALPHABET_SIZE; i++)
+            stats->code_bits += (double)freq_table[i] * lengths[i];
+}
+
+void count_block(Stats *stats, unsigned char type) {
+    /**
+     * @brief Учитывает блок в общем счётчике и в счётчике его типа.
+     *
+     * @param stats Указатель на статистику.
+     * @param type Тип блока из заголовка.
+     */
+    stats->blocks++;
+    if (type < BLOCK_TYPES)
+        stats->block_types[type]++;
+}
+
+void merge_stats(Stats *total, const Stats *part) {
+    /**
+     * @brief Прибавляет статистику part к total.
+     *
+     * @param total Накопленная статистика.
+     * @param part Статистика одного блока или потока.
+     */
+    for (size_t i = 0; i < STATS_PHASES; i++)
+        total->seconds[i] += part->seconds[i];
+    total->wall += part->wall;
+    total->original_size += part->original_size;
+    total->archive_size += part->archive_size;
+    total->blocks += part->blocks;
+    for (size_t i = 0; i < BLOCK_TYPES; i++)
+        total->block_types[i] += part->block_types[i];
+    for (size_t i = 0; i < ALPHABET_SIZE; i++)
+        total->freq_table[i] += part->freq_table[i];
+    total->code_bits += part->code_bits;
+    total->entropy_bits += part->entropy_bits;
+}
+
+static double per_byte(double value, unsigned long long size) {
+    /**
+     * @brief Делит значение на размер, возвращая 0 для пустых данных.
+     */
+    return size ? value / (double)size : 0.0;
+}
+
+void print_stats(const Stats *stats, char mode, int json, FILE *output) {
+    /**
+     * @brief Выводит статистику в текстовом виде или в формате JSON.
+     *
+     * Для каждой фазы выводятся время и скорость относительно размера
+     * исходных данных; для сжатия — также энтропия файла, граница Шеннона
+     * для поблочных кодов и средняя длина кода (в битах на байт).
+     * Количество блоков выводится и по типам. Фазы, не относящиеся
+     * к режиму, не выводятся.
+     *
+     * @param stats Статистика.
+     * @param mode Режим: 'c' — сжатие, 'd' — распаковка, 'x' — извлечение диапазона.
+     * @param json 1 — вывести одну строку JSON; 0 — текст.
+     * @param output Файл для вывода.
+     */
+    unsigned long long total;
+    double file_entropy = entropy(stats->freq_table, &total);
+    double bound = per_byte(stats->entropy_bits, stats->original_size);
+    double average = per_byte(stats->code_bits, stats->original_size);
+    double mb = (double)stats->original_size / 1e6;
+    size_t first = (mode == 'c') ? STATS_HISTOGRAM : STATS_DECODE;
+    size_t last = (mode == 'c') ? STATS_WAIT : STATS_DECODE;
+
+    if (json) {
+        fprintf(output, "{\"mode\":\"%s\",\"wall_seconds\":%.6f,\"original_bytes\":%llu,"
+                "\"archive_bytes\":%llu,\"blocks\":%llu,\"throughput_mb_s\":%.3f,\"phases\":{",
+                (mode == 'c') ? "compress" : (mode == 'x') ? "extract" : "decompress", stats->wall, stats->original_size,
+                stats->archive_size, stats->blocks, stats->wall > 0 ? mb / stats->wall : 0.0);
+        for (size_t i = first; i <= last; i++)
+            fprintf(output, "%s\"%s\":{\"seconds\":%.6f,\"mb_s\":%.3f}", (i == first) ? "" : ",",
+                    PHASE_NAMES[i], stats->seconds[i], stats->seconds[i] > 0 ? mb / stats->seconds[i] : 0.0);
+        fputs("},\"block_types\":{", output);
+        for (size_t i = BLOCK_HUFFMAN; i < BLOCK_TYPES; i++)
+            fprintf(output, "%s\"%s\":%llu", (i == BLOCK_HUFFMAN) ? "" : ",", BLOCK_TYPE_NAMES[i],
+                    stats->block_types[i]);
+        fputs("}", output);
+        if (mode == 'c')
+            fprintf(output, ",\"entropy_bits_per_byte\":%.6f,\"shannon_bound_bits_per_byte\":%.6f,"
+                    "\"average_code_length\":%.6f", file_entropy, bound, average);
+        fputs("}\n", output);
+        return;
+    }
+
+    fprintf(output, "%-17s %12.6f s %10.1f MB/s\n", "total", stats->wall,
+            stats->wall > 0 ? mb / stats->wall : 0.0);
+    for (size_t i = first; i <= last; i++)
+        fprintf(output, "%-17s %12.6f s %10.1f MB/s\n", PHASE_NAMES[i], stats->seconds[i],
+                stats->seconds[i] > 0 ? mb / stats->seconds[i] : 0.0);
+    fprintf(output, "%-17s %12llu\n%-17s %12llu\n%-17s %12llu\n", "original bytes", stats->original_size,
+            "archive bytes", stats->archive_size, "blocks", stats->blocks);
+    for (size_t i = BLOCK_HUFFMAN; i < BLOCK_TYPES; i++)
+        if (stats->block_types[i])
+            fprintf(output, "  %-15s %12llu\n", BLOCK_TYPE_NAMES[i], stats->block_types[i]);
+    if (mode == 'c')
+        fprintf(output, "%-17s %12.4f bits/byte\n%-17s %12.4f bits/byte\n%-17s %12.4f bits/byte\n",
+                "entropy", file_entropy, "shannon bound", bound, "avg code length", average);
+}
@@ -0,0 +1,344 @@
+#include <string.h>
+#include "huffman.h"
+#include "block.h"
+
+/// Этапы потокового контекста.
+enum {
+    STREAM_ARCHIVE_HEADER,      ///< Заголовок архива ещё не записан (не прочитан).
+    STREAM_BLOCK_HEADER,        ///< Ожидается заголовок блока (только распаковка).
+    STREAM_PAYLOAD,             ///< Накапливаются данные блока.
+    STREAM_FINISHED,            ///< Архив завершён.
+    STREAM_FAILED               ///< Произошла ошибка; контекст больше не работает.
+};
+
+/**
+ * Потоковый контекст.
+ *
+ * Данные накапливаются до целого блока: при сжатии — исходные байты,
+ * при распаковке — сжатые данные блока. Готовый результат выдаётся
+ * из двух частей (pending), пока в выходном буфере есть место, поэтому
+ * работа прерывается и продолжается на любой границе входа и выхода.
+ */
+struct HuffStream {
+    int mode;                               ///< HUFF_STREAM_COMPRESS или HUFF_STREAM_DECOMPRESS.
+    int stage;                              ///< Текущий этап STREAM_*.
+    const unsigned char *pending[2];        ///< Части готового выхода.
+    size_t pending_size[2];                 ///< Размеры частей готового выхода.
+    size_t part;                            ///< Выдаваемая часть (2 — всё выдано).
+    size_t sent;                            ///< Выдано байтов текущей части.
+    unsigned char *block;                   ///< Накапливаемые данные блока.
+    size_t block_capacity;                  ///< Размер буфера block.
+    size_t filled;                          ///< Накоплено байтов в block.
+    Writer frame;                           ///< Заголовки архива и блоков (сжатие).
+    Writer payload;                         ///< Сжатые данные блока (сжатие).
+    unsigned char header[BLOCK_HEADER_MAX_SIZE]; ///< Начало ещё не разобранного заголовка (распаковка).
+    size_t header_size;                     ///< Накоплено байтов заголовка.
+    ArchiveHeader archive;                  ///< Заголовок архива (распаковка).
+    BlockHeader current;                    ///< Заголовок текущего блока (распаковка).
+    unsigned long long total;               ///< Распаковано байтов.
+    unsigned char *out;                     ///< Буфер распакованного блока, если он не помещается в выход.
+    size_t out_capacity;                    ///< Размер буфера out.
+    DecodeTable table;                      ///< Таблица декодирования (распаковка).
+};
+
+HuffStream* huff_stream_init(int mode) {
+    /**
+     * @brief Создаёт потоковый контекст сжатия или распаковки.
+     *
+     * @param mode HUFF_STREAM_COMPRESS или HUFF_STREAM_DECOMPRESS.
+     * @return Указатель на контекст или NULL при ошибке выделения памяти.
+     */
+    if (mode != HUFF_STREAM_COMPRESS && mode != HUFF_STREAM_DECOMPRESS)
+        return NULL;
+    HuffStream *stream = (HuffStream*)calloc(1, sizeof(HuffStream));
+    if (!stream)
+        return NULL;
+    stream->mode = mode;
+    stream->stage = STREAM_ARCHIVE_HEADER;
+    stream->part = 2;
+    init_decode_table(&stream->table);
+    if (mode == HUFF_STREAM_COMPRESS) {
+        int ok = reserve_buffer(&stream->block, &stream->block_capacity, DEFAULT_BLOCK_SIZE)
+            && init_memory_writer(&stream->frame, ARCHIVE_HEADER_MAX_SIZE + BLOCK_HEADER_MAX_SIZE);
+        if (!ok || !init_memory_writer(&stream->payload, BITIO_BUFFER_SIZE)) {
+            if (ok)
+                delete_writer(&stream->frame);
+            free(stream->block);
+            free(stream);
+            return NULL;
+        }
+    }
+    return stream;
+}
+
+void huff_stream_end(HuffStream *stream) {
+    /**
+     * @brief Освобождает потоковый контекст.
+     *
+     * Незавершённый архив при этом отбрасывается.
+     *
+     * @param stream Указатель на контекст (может быть NULL).
+     */
+    if (!stream)
+        return;
+    if (stream->mode == HUFF_STREAM_COMPRESS) {
+        delete_writer(&stream->frame);
+        delete_writer(&stream->payload);
+    }
+    free(stream->block);
+    free(stream->out);
+    delete_decode_table(&stream->table);
+    free(stream);
+}
+
+static void set_pending(HuffStream *stream, const unsigned char *first, size_t first_size,
+                        const unsigned char *second, size_t second_size) {
+    /**
+     * @brief Задаёт готовый выход из двух частей (вторая может быть пустой).
+     *
+     * @param stream Потоковый контекст.
+     * @param first Первая часть.
+     * @param first_size Размер первой части.
+     * @param second Вторая часть.
+     * @param second_size Размер второй части.
+     */
+    stream->pending[0] = first;
+    stream->pending_size[0] = first_size;
+    stream->pending[1] = second;
+    stream->pending_size[1] = second_size;
+    stream->part = 0;
+    stream->sent = 0;
+}
+
+static int drain(HuffStream *stream, unsigned char *out, size_t capacity, size_t *written) {
+    /**
+     * @brief Выдаёт готовый выход, пока в выходном буфере есть место.
+     *
+     * @param stream Потоковый контекст.
+     * @param out Выходной буфер.
+     * @param capacity Размер выходного буфера.
+     * @param written Количество уже записанных в него байтов.
+     * @return 1 - если готовый выход выдан целиком; 0 - если выходной буфер заполнен.
+     */
+    while (stream->part < 2) {
+        size_t rest = stream->pending_size[stream->part] - stream->sent;
+        size_t n = (rest < capacity - *written) ? rest : capacity - *written;
+        if (n)
+            memcpy(out + *written, stream->pending[stream->part] + stream->sent, n);
+        *written += n;
+        stream->sent += n;
+        if (stream->sent < stream->pending_size[stream->part])
+            return 0;
+        stream->part++;
+        stream->sent = 0;
+    }
+    return 1;
+}
+
+static int compress_update(HuffStream *stream, const unsigned char *in, size_t *in_len,
+                           unsigned char *out, size_t *out_len, int finish) {
+    /**
+     * @brief Шаг потокового сжатия.
+     *
+     * Вход накапливается в блоки по DEFAULT_BLOCK_SIZE байтов; если целый блок
+     * уже есть во входе, он сжимается прямо оттуда, без копирования. Архив
+     * имеет тот же формат, что у compress_archive(), но размер исходных
+     * данных в заголовке не записывается: он заранее неизвестен.
+     *
+     * @param stream Потоковый контекст.
+     * @param in Входные данные.
+     * @param in_len На входе — размер in, на выходе — количество использованных байтов.
+     * @param out Выходной буфер.
+     * @param out_len На входе — размер out, на выходе — количество записанных байтов.
+     * @param finish 1 - после in входных данных больше не будет.
+     * @return HUFF_STREAM_OK, HUFF_STREAM_END или HUFF_STREAM_ERROR.
+     */
+    size_t used = 0, written = 0;
+    int status = HUFF_STREAM_OK;
+    while (drain(stream, out, *out_len, &written)) {
+        if (stream->stage == STREAM_FINISHED) {
+            status = HUFF_STREAM_END;
+            break;
+        }
+        reset_writer(&stream->frame);
+        if (stream->stage == STREAM_ARCHIVE_HEADER) {
+            ArchiveHeader archive = { 0, 0 };
+            write_archive_header(&stream->frame, &archive);
+            write_last(&stream->frame);
+            set_pending(stream, stream->frame.buffer, stream->frame.pos, NULL, 0);
+            stream->stage = STREAM_PAYLOAD;
+            continue;
+        }
+
+        const unsigned char *data = stream->block;
+        if (stream->filled == 0 && *in_len - used >= DEFAULT_BLOCK_SIZE) {
+            data = in + used;
+            used += DEFAULT_BLOCK_SIZE;
+            stream->filled = DEFAULT_BLOCK_SIZE;
+        }
+        else {
+            size_t n = DEFAULT_BLOCK_SIZE - stream->filled;
+            n = (*in_len - used < n) ? *in_len - used : n;
+            if (n)
+                memcpy(stream->block + stream->filled, in + used, n);
+            used += n;
+            stream->filled += n;
+        }
+
+        int last = finish && used == *in_len;
+        if (stream->filled == DEFAULT_BLOCK_SIZE || (last && stream->filled > 0)) {
+            BlockHeader header;
+            header.original_size = stream->filled;
+            header.type = encode_block(data, stream->filled, DEFAULT_CODE_LENGTH, &stream->payload);
+            header.payload_size = stream->payload.pos;
+            write_block_header(&stream->frame, &header);
+            write_last(&stream->frame);
+            set_pending(stream, stream->frame.buffer, stream->frame.pos, stream->payload.buffer, header.payload_size);
+            stream->filled = 0;
+        }
+        else if (last) {
+            write_end_block(&stream->frame);
+            write_last(&stream->frame);
+            set_pending(stream, stream->frame.buffer, stream->frame.pos, NULL, 0);
+            stream->stage = STREAM_FINISHED;
+        }
+        else break;
+        if (stream->frame.error || stream->payload.error) {
+            status = HUFF_STREAM_ERROR;
+            break;
+        }
+    }
+    *in_len = used;
+    *out_len = written;
+    return status;
+}
+
+static int decompress_update(HuffStream *stream, const unsigned char *in, size_t *in_len,
+                             unsigned char *out, size_t *out_len, int finish) {
+    /**
+     * @brief Шаг потоковой распаковки.
+     *
+     * Заголовки разбираются, как только получены целиком; сжатые данные блока
+     * накапливаются до payload_size байтов (или берутся прямо из входа, если
+     * блок в нём уже есть целиком) и декодируются сразу в выходной буфер,
+     * если в нём хватает места, иначе — во внутренний буфер, выдаваемый частями.
+     *
+     * @param stream Потоковый контекст.
+     * @param in Входные данные (архив).
+     * @param in_len На входе — размер in, на выходе — количество использованных байтов.
+     * @param out Выходной буфер.
+     * @param out_len На входе — размер out, на выходе — количество записанных байтов.
+     * @param finish 1 - после in входных данных больше не будет.
+     * @return HUFF_STREAM_OK, HUFF_STREAM_END или HUFF_STREAM_ERROR.
+     */
+    size_t used = 0, written = 0;
+    int status = HUFF_STREAM_OK;
+    int ok = 1;
+    while (ok && drain(stream, out, *out_len, &written)) {
+        if (stream->stage == STREAM_FINISHED) {
+            status = HUFF_STREAM_END;
+            break;
+        }
+        if (stream->stage == STREAM_ARCHIVE_HEADER || stream->stage == STREAM_BLOCK_HEADER) {
+            size_t limit = (stream->stage == STREAM_ARCHIVE_HEADER) ? ARCHIVE_HEADER_MAX_SIZE : BLOCK_HEADER_MAX_SIZE;
+            size_t n = (*in_len - used < limit - stream->header_size) ? *in_len - used : limit - stream->header_size;
+            if (n)
+                memcpy(stream->header + stream->header_size, in + used, n);
+            Reader reader;
+            init_memory_reader(&reader, stream->header, stream->header_size + n);
+            int parsed = (stream->stage == STREAM_ARCHIVE_HEADER)
+                ? read_archive_header(&reader, &stream->archive)
+                : read_block_header(&reader, &stream->current);
+            if (!parsed) {
+                used += n;
+                stream->header_size += n;
+                ok = stream->header_size < limit && !(finish && used == *in_len);
+                break;
+            }
+            used += (reader.pos - reader.bits_filled / 8) - stream->header_size;
+            stream->header_size = 0;
+            if (stream->stage == STREAM_ARCHIVE_HEADER) {
+                stream->stage = STREAM_BLOCK_HEADER;
+                continue;
+            }
+            if (stream->current.type == BLOCK_END) {
+                ok = !(stream->archive.flags & ARCHIVE_SIZE_KNOWN) || stream->total == stream->archive.original_size;
+                stream->stage = STREAM_FINISHED;
+                continue;
+            }
+            stream->total += stream->current.original_size;
+            ok = !(stream->archive.flags & ARCHIVE_SIZE_KNOWN) || stream->total <= stream->archive.original_size;
+            stream->stage = STREAM_PAYLOAD;
+            stream->filled = 0;
+            continue;
+        }
+
+        const BlockHeader *header = &stream->current;
+        const unsigned char *payload = stream->block;
+        if (stream->filled == 0 && *in_len - used >= header->payload_size) {
+            payload = in + used;
+            used += header->payload_size;
+        }
+        else {
+            size_t n = header->payload_size - stream->filled;
+            n = (*in_len - used < n) ? *in_len - used : n;
+            ok = reserve_buffer(&stream->block, &stream->block_capacity, header->payload_size);
+            if (ok && n)
+                memcpy(stream->block + stream->filled, in + used, n);
+            used += n;
+            stream->filled += n;
+            if (ok && stream->filled < header->payload_size) {
+                ok = !(finish && used == *in_len);
+                break;
+            }
+            payload = stream->block;
+        }
+
+        if (*out_len - written >= header->original_size) {
+            ok = ok && decode_block(header, payload, &stream->table, out + written);
+            written += header->original_size;
+        }
+        else {
+            ok = ok && reserve_buffer(&stream->out, &stream->out_capacity, header->original_size)
+                && decode_block(header, payload, &stream->table, stream->out);
+            set_pending(stream, stream->out, header->original_size, NULL, 0);
+        }
+        stream->stage = STREAM_BLOCK_HEADER;
+    }
+    if (!ok)
+        status = HUFF_STREAM_ERROR;
+    *in_len = used;
+    *out_len = written;
+    return status;
+}
+
+int huff_stream_update(HuffStream *stream, const void *in, size_t *in_len, void *out, size_t *out_len, int finish) {
+    /**
+     * @brief Обрабатывает очередную порцию входа и выдаёт готовый выход.
+     *
+     * Использует столько входа и заполняет столько выхода, сколько может;
+     * неиспользованный вход нужно передать при следующем вызове. После того
+     * как вход закончился, функцию вызывают с finish = 1, пока она не вернёт
+     * HUFF_STREAM_END (при сжатии это дописывает последний блок и конец архива).
+     *
+     * @param stream Потоковый контекст.
+     * @param in Входные данные (может быть NULL при *in_len == 0).
+     * @param in_len На входе — размер in, на выходе — количество использованных байтов.
+     * @param out Выходной буфер.
+     * @param out_len На входе — размер out, на выходе — количество записанных байтов.
+     * @param finish 1 - после in входных данных больше не будет.
+     * @return HUFF_STREAM_OK - нужен ещё вход или место для выхода; HUFF_STREAM_END - архив
+     * завершён и весь выход выдан; HUFF_STREAM_ERROR - ошибка памяти или повреждённый архив.
+     */
+    if (stream->stage == STREAM_FAILED) {
+        *in_len = 0;
+        *out_len = 0;
+        return HUFF_STREAM_ERROR;
+    }
+    int status = (stream->mode == HUFF_STREAM_COMPRESS)
+        ? compress_update(stream, (const unsigned char*)in, in_len, (unsigned char*)out, out_len, finish)
+        : decompress_update(stream, (const unsigned char*)in, in_len, (unsigned char*)out, out_len, finish);
+    if (status == HUFF_STREAM_ERROR)
+        stream->stage = STREAM_FAILED;
+    return status;
+}